@@ -27,6 +27,7 @@
 #include "cmdlineparser.h"
 #include "path.h"
 #include "filelister.h"
+#include "threadexecutor.h"
 
 #ifdef HAVE_RULES
 // xml is used in rules
@@ -256,7 +257,7 @@ bool CmdLineParser::ParseFromArgs(int argc, const char* const argv[])
         // Check if there are unused functions
         else if (strcmp(argv[i], "--unused-functions") == 0)
         {
-            const std::string errmsg = _settings->addEnabled("unusedFunctions");
+            const std::string errmsg = _settings->addEnabled("unusedFunction");
             if (!errmsg.empty())
             {
                 PrintMessage(errmsg);
@@ -268,6 +269,17 @@ bool CmdLineParser::ParseFromArgs(int argc, const char* const argv[])
         else if (strncmp(argv[i], "--append=", 9) == 0)
             _settings->append(9 + argv[i]);
 
+        // Save results and reuse them for unchanged files
+        else if (strncmp(argv[i], "--cache-dir=", 12) == 0)
+        {
+            _settings->_cacheDir = 12 + argv[i];
+            if (_settings->_cacheDir.empty())
+            {
+                PrintMessage("cppcheck: No directory specified for the --cache-dir option");
+                return false;
+            }
+        }
+
         else if (strncmp(argv[i], "--enable=", 9) == 0)
         {
             const std::string errmsg = _settings->addEnabled(argv[i] + 9);
@@ -463,6 +475,26 @@ bool CmdLineParser::ParseFromArgs(int argc, const char* const argv[])
             }
         }
 
+        // Run the jobs in threads or in processes
+        else if (strncmp(argv[i], "--executor=", 11) == 0)
+        {
+            const std::string executor(argv[i] + 11);
+            if (executor == "thread")
+                _settings->_processExecutor = false;
+            else if (executor == "process" && ThreadExecutor::processesEnabled())
+                _settings->_processExecutor = true;
+            else if (executor == "process")
+            {
+                PrintMessage("cppcheck: --executor=process is not supported on this platform");
+                return false;
+            }
+            else
+            {
+                PrintMessage("cppcheck: there is no --executor with the name '" + executor + "'");
+                return false;
+            }
+        }
+
         // deprecated: auto deallocated classes..
         else if (strcmp(argv[i], "--auto-dealloc") == 0)
         {
@@ -513,6 +545,8 @@ bool CmdLineParser::ParseFromArgs(int argc, const char* const argv[])
                 _settings->_showtime = SHOWTIME_SUMMARY;
             else if (showtimeMode == "top5")
                 _settings->_showtime = SHOWTIME_TOP5;
+            else if (showtimeMode == "json")
+                _settings->_showtime = SHOWTIME_JSON;
             else
                 _settings->_showtime = SHOWTIME_NONE;
         }
@@ -588,17 +622,6 @@ bool CmdLineParser::ParseFromArgs(int argc, const char* const argv[])
             _pathnames.push_back(Path::fromNativeSeparators(argv[i]));
     }
 
-    if (_settings->isEnabled("unusedFunctions") && _settings->_jobs > 1)
-    {
-        PrintMessage("unusedFunctions check can't be used with -j option, so it was disabled.");
-    }
-
-    // FIXME: Make the _settings.test_2_pass thread safe
-    if (_settings->test_2_pass && _settings->_jobs > 1)
-    {
-        PrintMessage("--test-2-pass doesn't work with -j option yet.");
-    }
-
     if (argc <= 1)
         _showHelp = true;
 
@@ -630,6 +653,14 @@ void CmdLineParser::PrintHelp()
               "Options:\n"
               "    --append=<file>      This allows you to provide information about\n"
               "                         functions by providing an implementation for these.\n"
+              "    --cache-dir=<dir>    Save the results in the given directory. Files that\n"
+              "                         are unchanged since they were checked with the same\n"
+              "                         options are not checked again, the saved results are\n"
+              "                         reported instead. The functions that the files\n"
+              "                         define and use and the --test-2-pass analysis are\n"
+              "                         saved too, only changed files are tokenized again\n"
+              "                         for the whole program checks. The directory must\n"
+              "                         exist.\n"
               "    -D<ID>               By default Cppcheck checks all configurations.\n"
               "                         Use -D to limit the checking. When -D is used the\n"
               "                         checking is limited to the given configuration.\n"
@@ -648,6 +679,10 @@ void CmdLineParser::PrintHelp()
               "                         provided. Note that your operating system can\n"
               "                         modify this value, e.g. 256 can become 0.\n"
               "    --errorlist          Print a list of all error messages in XML format.\n"
+              "    --executor=<type>    How the jobs given with -j are run:\n"
+              "                          * thread - threads in the cppcheck process. This is\n"
+              "                                     the default.\n"
+              "                          * process - a new process for each file\n"
               "    --exitcode-suppressions=<file>\n"
               "                         Used when certain messages should be displayed but\n"
               "                         should not cause a non-zero exitcode.\n"
@@ -668,7 +703,8 @@ void CmdLineParser::PrintHelp()
               "                         on the lines before the warning to suppress.\n"
               "    -j <jobs>            Start [jobs] threads to do the checking simultaneously.\n"
               "    -q, --quiet          Only print error messages.\n"
-              "    --report-progress    Report progress messages while checking a file.\n"
+              "    --report-progress    Report progress messages while checking a file. Not\n"
+              "                         supported with --executor=process.\n"
               "    --rule=<rule>        Match regular expression.\n"
               "    --rule-file=<file>   Use given rule file. For more information, see: \n"
               "                         https://sourceforge.net/projects/cppcheck/files/Articles/\n"
@@ -19,6 +19,8 @@
 #include "cppcheckexecutor.h"
 #include "cppcheck.h"
 #include "threadexecutor.h"
+#include "progress.h"
+#include "threading.h"
 #include <fstream>
 #include <iostream>
 #include <cstdlib> // EXIT_SUCCESS and EXIT_FAILURE
@@ -29,7 +31,6 @@
 
 CppCheckExecutor::CppCheckExecutor()
 {
-    time1 = 0;
     errorlist = false;
 }
 
@@ -129,10 +130,15 @@ int CppCheckExecutor::check(int argc, const char* const argv[])
         return EXIT_FAILURE;
     }
 
-    if (cppCheck.settings().reportProgress)
-        time1 = std::time(0);
-
     _settings = cppCheck.settings();
+
+    // Report progress messages every 10 seconds. The files are not
+    // checked in this process with --executor=process, and a fork()
+    // must not happen while the reporter thread holds a lock.
+    ProgressReporter progressReporter(*this);
+    if (_settings.reportProgress && (_settings._jobs == 1 || !_settings._processExecutor))
+        progressReporter.start(10000);
+
     if (_settings._xml)
     {
         reportErr(ErrorLogger::ErrorMessage::getXMLHeader(_settings._xml_version));
@@ -157,6 +163,8 @@ int CppCheckExecutor::check(int argc, const char* const argv[])
         returnValue = executor.check();
     }
 
+    progressReporter.stop();
+
     reportUnmatchedSuppressions(cppCheck.settings().nomsg.getUnmatchedGlobalSuppressions());
 
     if (_settings._xml)
@@ -164,6 +172,9 @@ int CppCheckExecutor::check(int argc, const char* const argv[])
         reportErr(ErrorLogger::ErrorMessage::getXMLFooter(_settings._xml_version));
     }
 
+    if (_settings._showtime != SHOWTIME_NONE && _settings._showtime != SHOWTIME_FILE)
+        CppCheck::timerResults().ShowResults(_settings._showtime);
+
     if (returnValue)
         return _settings._exitCode;
     else
@@ -172,11 +183,13 @@ int CppCheckExecutor::check(int argc, const char* const argv[])
 
 void CppCheckExecutor::reportErr(const std::string &errmsg)
 {
+    Mutex::Lock lock(outputMutex);
     std::cerr << errmsg << std::endl;
 }
 
 void CppCheckExecutor::reportOut(const std::string &outmsg)
 {
+    Mutex::Lock lock(outputMutex);
     std::cout << outmsg << std::endl;
 }
 
@@ -184,29 +197,20 @@ void CppCheckExecutor::reportProgress(const std::string &filename, const char st
 {
     (void)filename;
 
-    if (!time1)
-        return;
+    // current time in the format "Www Mmm dd hh:mm:ss yyyy"
+    const std::time_t t = std::time(NULL);
+    const std::string str(std::ctime(&t));
 
-    // Report progress messages every 10 seconds
-    const std::time_t time2 = std::time(NULL);
-    if (time2 >= (time1 + 10))
-    {
-        time1 = time2;
-
-        // current time in the format "Www Mmm dd hh:mm:ss yyyy"
-        const std::string str(std::ctime(&time2));
+    // format a progress message
+    std::ostringstream ostr;
+    ostr << "progress: "
+         << stage
+         << " " << int(value) << "%";
+    if (_settings._verbose)
+        ostr << " time=" << str.substr(11, 8);
 
-        // format a progress message
-        std::ostringstream ostr;
-        ostr << "progress: "
-             << stage
-             << " " << int(value) << "%";
-        if (_settings._verbose)
-            ostr << " time=" << str.substr(11, 8);
-
-        // Report progress message
-        reportOut(ostr.str());
-    }
+    // Report progress message
+    reportOut(ostr.str());
 }
 
 void CppCheckExecutor::reportStatus(unsigned int index, unsigned int max)
@@ -218,7 +222,7 @@ void CppCheckExecutor::reportStatus(unsigned int index, unsigned int max)
             << " files checked " <<
             static_cast<int>(static_cast<double>(index) / max*100)
             << "% done";
-        std::cout << oss.str() << std::endl;
+        reportOut(oss.str());
     }
 }
 
@@ -98,11 +98,6 @@ protected:
 
 private:
 
-    /**
-     * Report progress time
-     */
-    std::time_t time1;
-
     /**
      * Has --errorlist been given?
      */
@@ -18,7 +18,13 @@
 
 #include "threadexecutor.h"
 #include "cppcheck.h"
+#include "timer.h"
+#include "threading.h"
+#include "check.h"
+#include "path.h"
 #include <iostream>
+#include <fstream>
+#include <sstream>
 #include <algorithm>
 #ifdef THREADING_MODEL_FORK
 #include <sys/wait.h>
@@ -34,6 +40,11 @@
 ThreadExecutor::ThreadExecutor(const std::vector<std::string> &filenames, Settings &settings, ErrorLogger &errorLogger)
     : _filenames(filenames), _settings(settings), _errorLogger(errorLogger), _fileCount(0)
 {
+    _mutex = 0;
+    _nextFile = 0;
+    _result = 0;
+    _spareJobs = 0;
+    _reportedErrors = 0;
 #ifdef THREADING_MODEL_FORK
     _wpipe = 0;
 #endif
@@ -49,12 +60,305 @@ void ThreadExecutor::addFileContent(const std::string &path, const std::string &
     _fileContents[ path ] = content;
 }
 
+unsigned int ThreadExecutor::check()
+{
+    _fileCount = 0;
+    _usage.clear();
+
+    Mutex mutex;
+    _mutex = &mutex;
+
+    // The analysis data is used when the files are checked
+    if (_settings.test_2_pass)
+        analyseFiles();
+
+    unsigned int result = 0;
+#ifdef THREADING_MODEL_FORK
+    if (_settings._processExecutor)
+        result = checkProcesses();
+    else
+#endif
+        result = checkThreads();
+
+    if (_settings.isEnabled("unusedFunction") && !_settings.terminated())
+        result += checkUnusedFunctions();
+
+    _mutex = 0;
+    return result;
+}
+
+void ThreadExecutor::reportOut(const std::string &outmsg)
+{
+#ifdef THREADING_MODEL_FORK
+    // Child process
+    if (_wpipe)
+    {
+        writeToPipe('1', outmsg);
+        return;
+    }
+#endif
+
+    Mutex::Lock lock(*_mutex);
+    _errorLogger.reportOut(outmsg);
+}
+
+void ThreadExecutor::reportErr(const ErrorLogger::ErrorMessage &msg)
+{
+#ifdef THREADING_MODEL_FORK
+    // Child process
+    if (_wpipe)
+    {
+        writeToPipe('2', msg.serialize());
+        return;
+    }
+#endif
+
+    Mutex::Lock lock(*_mutex);
+    reportUniqueErr(msg);
+}
+
+void ThreadExecutor::reportStatus(unsigned int /*index*/, unsigned int /*max*/)
+{
+    // Not used
+}
+
+void ThreadExecutor::reportUniqueErr(const ErrorLogger::ErrorMessage &msg)
+{
+    std::string file;
+    unsigned int line(0);
+    if (!msg._callStack.empty())
+    {
+        file = msg._callStack.back().getfile(false);
+        line = msg._callStack.back().line;
+    }
+
+    if (!_settings.nomsg.isSuppressed(msg._id, file, line))
+    {
+        // Alert only about unique errors
+        if (_errorList.insert(ReportedErrors::fingerprint(msg, _settings._verbose)))
+        {
+            _errorLogger.reportErr(msg);
+            ++_reportedErrors;
+        }
+    }
+}
+
+unsigned int ThreadExecutor::checkThreads()
+{
+    _nextFile = 0;
+    _result = 0;
+
+    // The calling thread is a worker too
+    unsigned int workers = _settings._jobs;
+    if (workers > _filenames.size())
+        workers = _filenames.size();
+
+    // Jobs that have no file to check can help with the configurations
+    _spareJobs = _settings._jobs - workers;
+    JobSlots::release(_spareJobs);
+
+    std::vector<Thread *> threads;
+    for (unsigned int i = 1; i < workers; ++i)
+    {
+        Thread *thread = new Thread;
+        if (!thread->start(threadProc, this))
+        {
+            // The files are checked by fewer workers
+            delete thread;
+            break;
+        }
+        threads.push_back(thread);
+    }
+
+    checkFiles();
+
+    for (unsigned int i = 0; i < threads.size(); ++i)
+        delete threads[i];
+
+    JobSlots::remove(_spareJobs);
+    return _result;
+}
+
+void ThreadExecutor::threadProc(void *executor)
+{
+    static_cast<ThreadExecutor *>(executor)->checkFiles();
+}
+
+unsigned int ThreadExecutor::nextFile()
+{
+    return static_cast<unsigned int>(Thread::fetchAndIncrement(_nextFile));
+}
+
+void ThreadExecutor::checkFiles()
+{
+    CppCheck fileChecker(*this, false);
+    {
+        // The suppressions in the settings are updated when errors are reported
+        Mutex::Lock lock(*_mutex);
+        fileChecker.settings(_settings);
+    }
+
+    for (unsigned int i = nextFile(); i < _filenames.size(); i = nextFile())
+    {
+        fileChecker.clearFiles();
+
+        const std::map<std::string, std::string>::const_iterator content = _fileContents.find(_filenames[i]);
+        if (content != _fileContents.end())
+        {
+            // File content was given as a string
+            fileChecker.addFile(_filenames[i], content->second);
+        }
+        else
+        {
+            // Read file from a file
+            fileChecker.addFile(_filenames[i]);
+        }
+
+        const unsigned int resultOfCheck = fileChecker.check();
+
+        Mutex::Lock lock(*_mutex);
+        if (!fileChecker.usageSummaries().empty())
+            _usage[_filenames[i]] = fileChecker.usageSummaries();
+        _result += resultOfCheck;
+        _fileCount++;
+        _errorLogger.reportStatus(_fileCount, _filenames.size());
+    }
+
+    // No more files, this job can help with the configurations of other files
+    Mutex::Lock lock(*_mutex);
+    ++_spareJobs;
+    JobSlots::release(1);
+}
+
+void ThreadExecutor::analyseFiles()
+{
+    _nextFile = 0;
+    _analysisData.clear();
+
+    unsigned int workers = _settings._jobs;
+    if (workers > _filenames.size())
+        workers = _filenames.size();
+
+    std::vector<Thread *> threads;
+    for (unsigned int i = 1; i < workers; ++i)
+    {
+        Thread *thread = new Thread;
+        if (!thread->start(analyseProc, this))
+        {
+            delete thread;
+            break;
+        }
+        threads.push_back(thread);
+    }
+
+    analyseNextFiles();
+
+    for (unsigned int i = 0; i < threads.size(); ++i)
+        delete threads[i];
+
+    // Save the analysis data once. The checks only read it while the
+    // files are checked, the forked children get a copy.
+    for (std::list<Check *>::const_iterator it = Check::instances().begin(); it != Check::instances().end(); ++it)
+        (*it)->saveAnalysisData(_analysisData);
+}
+
+void ThreadExecutor::analyseProc(void *executor)
+{
+    static_cast<ThreadExecutor *>(executor)->analyseNextFiles();
+}
+
+void ThreadExecutor::analyseNextFiles()
+{
+    CppCheck fileAnalyser(*this, false);
+    {
+        Mutex::Lock lock(*_mutex);
+        fileAnalyser.settings(_settings);
+    }
+
+    std::set<std::string> data;
+    for (unsigned int i = nextFile(); i < _filenames.size(); i = nextFile())
+    {
+        if (_settings.terminated())
+            break;
+
+        reportOut("Analysing " + Path::toNativeSeparators(_filenames[i]) + "..");
+
+        const std::map<std::string, std::string>::const_iterator content = _fileContents.find(_filenames[i]);
+        if (content != _fileContents.end())
+        {
+            std::istringstream iss(content->second);
+            fileAnalyser.analyseFile(iss, _filenames[i], data);
+        }
+        else
+        {
+            std::ifstream fin(_filenames[i].c_str());
+            fileAnalyser.analyseFile(fin, _filenames[i], data);
+        }
+    }
+
+    Mutex::Lock lock(*_mutex);
+    _analysisData.insert(data.begin(), data.end());
+}
+
+unsigned int ThreadExecutor::checkUnusedFunctions()
+{
+    // Merge the files in the order that they are checked without -j
+    CheckUnusedFunctions checkUnusedFunctions(0, &_settings, this);
+    for (std::map<std::string, std::list<CheckUnusedFunctions::Summary> >::const_iterator file = _usage.begin(); file != _usage.end(); ++file)
+    {
+        for (std::list<CheckUnusedFunctions::Summary>::const_iterator it = file->second.begin(); it != file->second.end(); ++it)
+            checkUnusedFunctions.merge(*it);
+    }
+
+    if (_settings._errorsOnly == false)
+        reportOut("Checking usage of global functions..");
+
+    // This generates false positives - especially for libraries
+    const bool verbose_orig = _settings._verbose;
+    _settings._verbose = false;
+    const unsigned int reportedErrors = _reportedErrors;
+    checkUnusedFunctions.check(this);
+    _settings._verbose = verbose_orig;
+
+    return (_reportedErrors != reportedErrors) ? 1U : 0U;
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 ////// This code is for platforms that support fork() only ////////////////////
 ///////////////////////////////////////////////////////////////////////////////
 
 #ifdef THREADING_MODEL_FORK
 
+/**
+ * Read exactly len bytes from the non-blocking pipe. A message can be
+ * larger than what the pipe holds, so wait until the rest is written.
+ * @return false if the pipe was closed or there was an error
+ */
+static bool readAll(int rpipe, char *buf, unsigned int len)
+{
+    while (len > 0)
+    {
+        const ssize_t n = read(rpipe, buf, len);
+        if (n > 0)
+        {
+            buf += n;
+            len -= (unsigned int)n;
+        }
+        else if (n < 0 && errno == EAGAIN)
+        {
+            fd_set rfds;
+            FD_ZERO(&rfds);
+            FD_SET(rpipe, &rfds);
+            select(rpipe + 1, &rfds, NULL, NULL, NULL);
+        }
+        else if (n < 0 && errno == EINTR)
+            continue;
+        else
+            return false;
+    }
+    return true;
+}
+
 int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
 {
     char type = 0;
@@ -66,21 +370,21 @@ int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
         return -1;
     }
 
-    if (type != '1' && type != '2' && type != '3')
+    if (type != '1' && type != '2' && type != '3' && type != '4' && type != '5')
     {
         std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleRead error, type was:" << type << std::endl;
         exit(0);
     }
 
     unsigned int len = 0;
-    if (read(rpipe, &len, sizeof(len)) <= 0)
+    if (!readAll(rpipe, reinterpret_cast<char *>(&len), sizeof(len)))
     {
         std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleRead error, type was:" << type << std::endl;
         exit(0);
     }
 
     char *buf = new char[len];
-    if (read(rpipe, buf, len) <= 0)
+    if (!readAll(rpipe, buf, len))
     {
         std::cerr << "#### You found a bug from cppcheck.\nThreadExecutor::handleRead error, type was:" << type << std::endl;
         exit(0);
@@ -94,25 +398,23 @@ int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
     {
         ErrorLogger::ErrorMessage msg;
         msg.deserialize(buf);
-
-        std::string file;
-        unsigned int line(0);
-        if (!msg._callStack.empty())
-        {
-            file = msg._callStack.back().getfile(false);
-            line = msg._callStack.back().line;
-        }
-
-        if (!_settings.nomsg.isSuppressed(msg._id, file, line))
-        {
-            // Alert only about unique errors
-            std::string errmsg = msg.toString(_settings._verbose);
-            if (std::find(_errorList.begin(), _errorList.end(), errmsg) == _errorList.end())
-            {
-                _errorList.push_back(errmsg);
-                _errorLogger.reportErr(msg);
-            }
-        }
+        reportUniqueErr(msg);
+    }
+    else if (type == '4')
+    {
+        CppCheck::timerResults().merge(buf);
+    }
+    else if (type == '5')
+    {
+        // file name and the defined and used functions of the file
+        std::istringstream iss(buf);
+        std::string::size_type len = 0;
+        iss >> len;
+        iss.get();
+        std::string filename(len, ' ');
+        iss.read(&filename[0], (std::streamsize)len);
+        const std::string summaries(buf + static_cast<std::string::size_type>(iss.tellg()));
+        CheckUnusedFunctions::deserialize(summaries, _usage[filename]);
     }
     else if (type == '3')
     {
@@ -130,9 +432,8 @@ int ThreadExecutor::handleRead(int rpipe, unsigned int &result)
     return 1;
 }
 
-unsigned int ThreadExecutor::check()
+unsigned int ThreadExecutor::checkProcesses()
 {
-    _fileCount = 0;
     unsigned int result = 0;
 
     std::list<int> rpipes;
@@ -175,6 +476,9 @@ unsigned int ThreadExecutor::check()
                 close(pipes[0]);
                 _wpipe = pipes[1];
 
+                // Only the timer results of this child are sent to the parent
+                CppCheck::timerResults().clear();
+
                 CppCheck fileChecker(*this, false);
                 fileChecker.settings(_settings);
 
@@ -190,6 +494,15 @@ unsigned int ThreadExecutor::check()
                 }
 
                 unsigned int resultOfCheck = fileChecker.check();
+                if (_settings._showtime != SHOWTIME_NONE)
+                    writeToPipe('4', CppCheck::timerResults().serialize());
+                if (!fileChecker.usageSummaries().empty())
+                {
+                    std::ostringstream usage;
+                    usage << _filenames[i].length() << " " << _filenames[i]
+                          << CheckUnusedFunctions::serialize(fileChecker.usageSummaries());
+                    writeToPipe('5', usage.str());
+                }
                 std::ostringstream oss;
                 oss << resultOfCheck;
                 writeToPipe('3', oss.str());
@@ -288,38 +601,4 @@ void ThreadExecutor::writeToPipe(char type, const std::string &data)
     delete [] out;
 }
 
-void ThreadExecutor::reportOut(const std::string &outmsg)
-{
-    writeToPipe('1', outmsg);
-}
-
-void ThreadExecutor::reportErr(const ErrorLogger::ErrorMessage &msg)
-{
-    writeToPipe('2', msg.serialize());
-}
-
-void ThreadExecutor::reportStatus(unsigned int /*index*/, unsigned int /*max*/)
-{
-    // Not used
-}
-
-#else
-unsigned int ThreadExecutor::check()
-{
-    return 0;
-}
-
-void ThreadExecutor::reportOut(const std::string &/*outmsg*/)
-{
-
-}
-void ThreadExecutor::reportErr(const ErrorLogger::ErrorMessage &/*msg*/)
-{
-
-}
-
-void ThreadExecutor::reportStatus(unsigned int /*index*/, unsigned int /*max*/)
-{
-
-}
 #endif
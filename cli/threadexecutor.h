@@ -22,8 +22,12 @@
 #include <vector>
 #include <string>
 #include <list>
+#include <map>
+#include <set>
 #include "settings.h"
 #include "errorlogger.h"
+#include "threading.h"
+#include "checkunusedfunctions.h"
 
 #if (defined(__GNUC__) || defined(__sun)) && !defined(__MINGW32__)
 #define THREADING_MODEL_FORK
@@ -35,6 +39,17 @@
 /**
  * This class will take a list of filenames and settings and check then
  * all files using threads.
+ *
+ * By default a pool of worker threads is used. Each worker has its own
+ * CppCheck instance and takes the next file from the list until all files
+ * are checked. The reports of the workers are serialized with a lock.
+ * With --executor=process a child process is forked for each file instead.
+ *
+ * The whole program analysis is done in the same way: the files are
+ * analysed by the workers (--test-2-pass) and the analysis data is saved
+ * before the files are checked, and the workers return the functions that
+ * each file defines and uses. These are merged in file order when all
+ * files are checked and the unused functions are reported.
  */
 class ThreadExecutor : public ErrorLogger
 {
@@ -63,8 +78,60 @@ private:
     /** @brief Key is file name, and value is the content of the file */
     std::map<std::string, std::string> _fileContents;
 
+private:
+    /** @brief Check the files with worker threads */
+    unsigned int checkThreads();
+
+    /** @brief Worker thread: check files until all files are taken */
+    void checkFiles();
+
+    /** @brief Take the next file to check. Safe to call from several threads. */
+    unsigned int nextFile();
+
+    /** @brief Thread function, calls checkFiles() */
+    static void threadProc(void *executor);
+
+    /** @brief Analyse the files with worker threads and save the analysis data (--test-2-pass) */
+    void analyseFiles();
+
+    /** @brief Worker thread: analyse files until all files are taken */
+    void analyseNextFiles();
+
+    /** @brief Thread function, calls analyseNextFiles() */
+    static void analyseProc(void *executor);
+
+    /**
+     * @brief Merge the defined and used functions of all files and report the unused functions
+     * @return 1 if unused functions were reported
+     */
+    unsigned int checkUnusedFunctions();
+
+    /** @brief Analysis data of the analysed files (--test-2-pass) */
+    std::set<std::string> _analysisData;
+
+    /** @brief Defined and used functions of each checked file */
+    std::map<std::string, std::list<CheckUnusedFunctions::Summary> > _usage;
+
+    /** @brief Number of errors that are reported */
+    unsigned int _reportedErrors;
+
+    /** @brief Serializes the reports from the worker threads */
+    Mutex *_mutex;
+
+    /** @brief Index of the next file to check */
+    volatile long _nextFile;
+
+    /** @brief Sum of the results of the checked files */
+    unsigned int _result;
+
+    /** @brief Jobs that were given to JobSlots */
+    unsigned int _spareJobs;
+
 #ifdef THREADING_MODEL_FORK
 private:
+    /** @brief Check the files with a forked child process for each file */
+    unsigned int checkProcesses();
+
     /**
      * Read from the pipe, parse and handle what ever is in there.
      *@return -1 in case of error
@@ -78,7 +145,14 @@ private:
      * Not used in master process.
      */
     int _wpipe;
-    std::list<std::string> _errorList;
+#endif
+
+    /** @brief Report error unless it is suppressed or already reported */
+    void reportUniqueErr(const ErrorLogger::ErrorMessage &msg);
+
+    /** @brief Reported errors, only unique errors are reported */
+    ReportedErrors _errorList;
+
 public:
     /**
      * @return true if support for threads exist.
@@ -87,16 +161,18 @@ public:
     {
         return true;
     }
-#else
-public:
+
     /**
-     * @return true if support for threads exist.
+     * @return true if the jobs can be run in separate processes (--executor=process).
      */
-    static bool isEnabled()
+    static bool processesEnabled()
     {
+#ifdef THREADING_MODEL_FORK
+        return true;
+#else
         return false;
-    }
 #endif
+    }
 
 private:
     /** disabled copy constructor */
@@ -25,6 +25,7 @@
 #include "tokenize.h"
 #include "errorlogger.h"
 #include "mathlib.h"
+#include "progress.h"
 
 #include <algorithm>
 #include <sstream>
@@ -620,7 +621,7 @@ void CheckBufferOverrun::checkFunctionParameter(const Token &tok, unsigned int p
                         }
                     }
 
-                    else if (Token::Match(tok2, ", %any% ,|)") && tok2->next()->str()[0] == '\'')
+                    else if (Token::Match(tok2, ", %any% ,|)") && tok2->next()->isChar())
                     {
                         sizeArgumentAsChar(tok2->next());
                     }
@@ -1221,6 +1222,9 @@ void CheckBufferOverrun::checkScope(const Token *tok, const ArrayInfo &arrayInfo
 
 void CheckBufferOverrun::checkGlobalAndLocalVariable()
 {
+    const std::vector<std::string> &files = *_tokenizer->getFiles();
+    Progress progress(files.empty() ? "" : files.front(), "Check (BufferOverrun::checkGlobalAndLocalVariable)");
+
     // Count { and } when parsing all tokens
     int indentlevel = 0;
     for (const Token *tok = _tokenizer->tokens(); tok; tok = tok->next())
@@ -1247,9 +1251,7 @@ void CheckBufferOverrun::checkGlobalAndLocalVariable()
         if (tok->previous() && (!tok->previous()->isName() && !Token::Match(tok->previous(), "[;{}]")))
             continue;
 
-        _errorLogger->reportProgress(_tokenizer->getFiles()->front(),
-                                     "Check (BufferOverrun::checkGlobalAndLocalVariable)",
-                                     tok->progressValue());
+        progress.value(tok->progressValue());
 
         ArrayInfo arrayInfo;
         if (arrayInfo.declare(tok, *_tokenizer))
@@ -1577,13 +1579,13 @@ MathLib::bigint CheckBufferOverrun::countSprintfLength(const std::string &input_
                 break;
             case 'd':
                 i_d_x_f_found = true;
-                if (paramIter != parameters.end() && *paramIter && (*paramIter)->str()[0] != '"')
+                if (paramIter != parameters.end() && *paramIter && !(*paramIter)->isString())
                     parameterLength = (*paramIter)->str().length();
 
                 handleNextParameter = true;
                 break;
             case 's':
-                if (paramIter != parameters.end() && *paramIter && (*paramIter)->str()[0] == '"')
+                if (paramIter != parameters.end() && *paramIter && (*paramIter)->isString())
                     parameterLength = Token::getStrLength(*paramIter);
 
                 handleNextParameter = true;
@@ -2207,7 +2209,7 @@ void CheckBufferOverrun::executionPaths()
 
     // Perform checking - check how the arrayInfo arrays are used
     ExecutionPathBufferOverrun c(this, arrayInfo);
-    checkExecutionPaths(_tokenizer->tokens(), &c);
+    checkExecutionPaths(_tokenizer, &c);
 }
 
 
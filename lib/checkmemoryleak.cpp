@@ -26,6 +26,7 @@
 #include <cstring>
 #include <cstdlib>
 #include <iostream>
+#include <map>
 #include <sstream>
 #include <set>
 #include <stack>
@@ -858,6 +859,159 @@ static void addtoken(Token **rettail, const Token *tok, const std::string &str)
 }
 
 
+/**
+ * @brief The getcode output for statements that don't use the variable.
+ *
+ * Most statements of a function don't use a given variable. Their output
+ * is the same for all the variables of the function, so it is recorded
+ * when the first variable is checked and copied for the others. A recording
+ * goes from a statement start to the next one. It is only made and reused
+ * when the variable is not used in the recorded tokens, and the state that
+ * the output depends on is the same.
+ */
+class StatementCodeCache
+{
+public:
+    StatementCodeCache() : _recording(false), _recordTail(0), _recordStart(0), _recordIndentlevel(0),
+        _recordAlloctype(CheckMemoryLeak::No), _recordDealloctype(CheckMemoryLeak::No)
+    { }
+
+    /** @brief The recorded output of a statement */
+    class Code
+    {
+    public:
+        /** the output tokens: text, line number and file index */
+        std::vector<std::pair<std::string, std::pair<unsigned int, unsigned int> > > tokens;
+
+        /** the token where the next statement starts */
+        const Token *end;
+
+        /** how much the indentation is changed */
+        int indentlevel;
+
+        /** the variables used in the recorded tokens */
+        std::vector<unsigned int> varids;
+
+        bool uses(unsigned int varid) const
+        {
+            return std::binary_search(varids.begin(), varids.end(), varid);
+        }
+
+        /** Add the output tokens after rettail */
+        void copy(Token **rettail) const
+        {
+            for (unsigned int i = 0; i < tokens.size(); ++i)
+            {
+                (*rettail)->insertToken(tokens[i].first);
+                (*rettail) = (*rettail)->next();
+                (*rettail)->linenr(tokens[i].second.first);
+                (*rettail)->fileIndex(tokens[i].second.second);
+            }
+        }
+    };
+
+    /** Get the recorded output of the statement that starts at tok, 0 if not recorded */
+    const Code *find(const Token *tok, int indentlevel, CheckMemoryLeak::AllocType alloctype, CheckMemoryLeak::AllocType dealloctype) const
+    {
+        const std::map<Key, Code>::const_iterator it = _codes.find(Key(tok, indentlevel, alloctype, dealloctype));
+        return (it == _codes.end()) ? 0 : &it->second;
+    }
+
+    /** Start recording the output of the statement that starts at tok. The output is added after rettail. */
+    void record(const Token *tok, const Token *rettail, int indentlevel, CheckMemoryLeak::AllocType alloctype, CheckMemoryLeak::AllocType dealloctype)
+    {
+        _recording = true;
+        _recordStart = tok;
+        _recordTail = rettail;
+        _recordIndentlevel = indentlevel;
+        _recordAlloctype = alloctype;
+        _recordDealloctype = dealloctype;
+    }
+
+    bool recording() const
+    {
+        return _recording;
+    }
+
+    /** Stop recording without saving anything, the output can't be reused */
+    void cancel()
+    {
+        _recording = false;
+    }
+
+    /**
+     * Stop recording. The next statement starts at tok. The recording is
+     * saved if the variable was not used and the state was not changed.
+     */
+    void stop(const Token *tok, const Token *rettail, unsigned int varid, int indentlevel, CheckMemoryLeak::AllocType alloctype, CheckMemoryLeak::AllocType dealloctype)
+    {
+        _recording = false;
+        if (alloctype != _recordAlloctype || dealloctype != _recordDealloctype)
+            return;
+
+        // the variables used in the statement. Some patterns look into the
+        // block that follows it.
+        const Token *last = (tok->str() == "{" && tok->link()) ? tok->link() : tok;
+        std::set<unsigned int> varids;
+        for (const Token *tok2 = _recordStart; tok2; tok2 = tok2->next())
+        {
+            if (tok2->varId())
+                varids.insert(tok2->varId());
+            if (tok2 == last)
+                break;
+        }
+        if (varids.find(varid) != varids.end())
+            return;
+
+        Code &code = _codes[Key(_recordStart, _recordIndentlevel, _recordAlloctype, _recordDealloctype)];
+        for (const Token *tok2 = _recordTail->next(); tok2; tok2 = tok2->next())
+        {
+            code.tokens.push_back(std::make_pair(tok2->str(), std::make_pair(tok2->linenr(), tok2->fileIndex())));
+            if (tok2 == rettail)
+                break;
+        }
+        code.end = tok;
+        code.indentlevel = indentlevel - _recordIndentlevel;
+        code.varids.assign(varids.begin(), varids.end());
+    }
+
+private:
+    /** a statement start and the state at the start */
+    class Key
+    {
+    public:
+        Key(const Token *tok_, int indentlevel_, CheckMemoryLeak::AllocType alloctype_, CheckMemoryLeak::AllocType dealloctype_)
+            : tok(tok_), indentlevel(indentlevel_), alloctype(alloctype_), dealloctype(dealloctype_)
+        { }
+
+        bool operator<(const Key &k) const
+        {
+            if (tok != k.tok)
+                return tok < k.tok;
+            if (indentlevel != k.indentlevel)
+                return indentlevel < k.indentlevel;
+            if (alloctype != k.alloctype)
+                return alloctype < k.alloctype;
+            return dealloctype < k.dealloctype;
+        }
+
+        const Token *tok;
+        int indentlevel;
+        CheckMemoryLeak::AllocType alloctype;
+        CheckMemoryLeak::AllocType dealloctype;
+    };
+
+    std::map<Key, Code> _codes;
+
+    bool _recording;
+    const Token *_recordTail;
+    const Token *_recordStart;
+    int _recordIndentlevel;
+    CheckMemoryLeak::AllocType _recordAlloctype;
+    CheckMemoryLeak::AllocType _recordDealloctype;
+};
+
+
 Token *CheckMemoryLeakInFunction::getcode(const Token *tok, std::list<const Token *> callstack, const unsigned int varid, CheckMemoryLeak::AllocType &alloctype, CheckMemoryLeak::AllocType &dealloctype, bool classmember, unsigned int sz)
 {
     Token *rethead = 0, *rettail = 0;
@@ -873,10 +1027,19 @@ Token *CheckMemoryLeakInFunction::getcode(const Token *tok, std::list<const Toke
     rethead->fileIndex(tok->fileIndex());
     rettail = rethead;
 
+    // the output for statements that don't use the variable is shared by
+    // the variables of the function
+    StatementCodeCache * const cache = (varid > 0 && callstack.empty()) ? statementCodeCache : 0;
+    if (cache)
+        cache->cancel();
+
     int indentlevel = 0;
     int parlevel = 0;
     for (; tok; tok = tok->next())
     {
+        if (cache && cache->recording() && parlevel == 0 && Token::Match(tok, "[;{}]"))
+            cache->stop(tok, rettail, varid, indentlevel, alloctype, dealloctype);
+
         if (tok->str() == "{")
         {
             addtoken(&rettail, tok, "{");
@@ -901,6 +1064,20 @@ Token *CheckMemoryLeakInFunction::getcode(const Token *tok, std::list<const Toke
         // Start of new statement.. check if the statement has anything interesting
         if (Token::Match(tok, "[;{}]") && varid > 0 && parlevel == 0)
         {
+            if (cache && extravar.empty())
+            {
+                const StatementCodeCache::Code *code = cache->find(tok, indentlevel, alloctype, dealloctype);
+                if (!code)
+                    cache->record(tok, rettail, indentlevel, alloctype, dealloctype);
+                else if (!code->uses(varid))
+                {
+                    code->copy(&rettail);
+                    indentlevel += code->indentlevel;
+                    tok = code->end->previous();
+                    continue;
+                }
+            }
+
             if (Token::Match(tok->next(), "[{};]"))
                 continue;
 
@@ -1642,8 +1819,135 @@ Token *CheckMemoryLeakInFunction::getcode(const Token *tok, std::list<const Toke
 }
 
 
+/**
+ * @brief The positions of the simplifycode loop that must be visited again.
+ *
+ * The rules of the loop only look at the tokens from the one before the
+ * position to the 9th after it. A position where no rule applied stays
+ * unchanged until a token in that window is changed, so after the first
+ * pass only the positions around the changes are simplified again.
+ * The "switch" rule looks further ahead so it is always visited.
+ */
+class SimplifyWorklist
+{
+public:
+    SimplifyWorklist() : _all(true), _positions(0), _ahead(0), _last(0), _position(0), _done(true)
+    { }
+
+    /** Start a pass of the loop */
+    void startPass()
+    {
+        // All positions are visited in the first pass. When most of
+        // them have changed it is cheaper to visit them all too.
+        _all = (_positions == 0 || 2 * _pending.size() >= _positions);
+        if (!_all)
+        {
+            std::sort(_pending.begin(), _pending.end());
+            _pending.erase(std::unique(_pending.begin(), _pending.end()), _pending.end());
+        }
+        _current.swap(_pending);
+        _pending.clear();
+        _positions = 0;
+        _ahead = 0;
+        _last = 0;
+    }
 
+    /**
+     * Start simplifying a position of the loop.
+     * @param tok the position
+     * @param done the done flag of the loop. It is set to true, and
+     * the rules set it to false when they change something.
+     * @return true if the position must be simplified
+     */
+    bool visit(Token *tok, bool &done)
+    {
+        _position = tok;
+        _done = done;
+        done = true;
+        ++_positions;
 
+        if (_ahead > 0)
+        {
+            --_ahead;
+            return true;
+        }
+        return (_all ||
+                tok->str() == "switch" ||
+                std::binary_search(_current.begin(), _current.end(), tok));
+    }
+
+    /**
+     * Finish the simplification of the current position
+     * @param tok the position after the rules, the rules may move it forward
+     * @param done the done flag of the loop
+     * @return the next position to visit
+     */
+    Token *next(Token *tok, bool &done)
+    {
+        if (!done)
+        {
+            // The positions up to the last changed token are visited in
+            // the next pass, the ones after it in this pass. The changes
+            // are made in the order of the list so the positions before
+            // the previous change have already been added.
+            Token *start = _position;
+            for (unsigned int i = 0; i < window && start->previous() != _last; ++i)
+                start = start->previous();
+            add(start, tok ? tok->next() : NULL);
+            _last = tok;
+            _ahead = window;
+        }
+        done = done && _done;
+        return tok ? tok->next() : NULL;
+    }
+
+    /**
+     * Tokens from first to last have been changed outside the loop.
+     * The positions that can see them are visited in the next pass.
+     */
+    void changed(Token *first, const Token *last)
+    {
+        for (unsigned int i = 0; i < window && first->previous(); ++i)
+            first = first->previous();
+        for (unsigned int i = 0; last && i <= window; ++i)
+            last = last->next();
+        add(first, last);
+    }
+
+private:
+    /** The rules change at most 8 tokens after the position and look at 9 */
+    static const unsigned int window = 10;
+
+    void add(Token *tok, const Token *end)
+    {
+        for (; tok && tok != end; tok = tok->next())
+            _pending.push_back(tok);
+    }
+
+    /**
+     * Sorted positions to visit in this pass. Deleted tokens can stay
+     * here, which only costs an extra visit if their memory is reused.
+     */
+    std::vector<const Token *> _current;
+
+    /** Positions to visit in the next pass */
+    std::vector<const Token *> _pending;
+
+    /** Visit all positions in this pass */
+    bool _all;
+
+    /** Number of positions in this pass */
+    std::size_t _positions;
+
+    /** Number of following positions to visit after a change */
+    unsigned int _ahead;
+
+    /** The last position that has been added in this pass */
+    const Token *_last;
+
+    Token *_position;
+    bool _done;
+};
 
 
 void CheckMemoryLeakInFunction::simplifycode(Token *tok)
@@ -1713,7 +2017,9 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
     // reduce the code..
     // it will be reduced in N passes. When a pass completes without any
     // simplifications the loop is done.
+    // After the first pass only the changed parts of the code are simplified.
     bool done = false;
+    SimplifyWorklist worklist;
     while (! done)
     {
         //tok->printOut("simplifycode loop..");
@@ -1725,7 +2031,10 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
             if (tok2->str() == "callfunc")
             {
                 if (!Token::Match(tok2->previous(), "[;{}] callfunc ; }"))
+                {
                     tok2->deleteThis();
+                    worklist.changed(tok2, tok2);
+                }
             }
         }
 
@@ -1738,6 +2047,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                 tok->deleteThis();
             if (tok->strAt(1) == "else")
                 tok->deleteNext();
+            worklist.changed(tok, tok->next());
         }
 
         // simplify "while1" contents..
@@ -1761,6 +2071,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                         Token::eraseTokens(tok3, tok3->tokAt(6));
                         if (Token::simpleMatch(tok3->next(), "else"))
                             tok3->deleteNext();
+                        worklist.changed(tok3, tok3);
                     }
                 }
 
@@ -1769,13 +2080,18 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                     tok2->str(";");
                     Token::eraseTokens(tok2, tok2->tokAt(4));
                     Token::eraseTokens(tok2->tokAt(4), tok2->tokAt(7));
+                    worklist.changed(tok2, tok2->tokAt(4));
                 }
             }
         }
 
         // Main inner simplification loop
-        for (Token *tok2 = tok; tok2; tok2 = tok2 ? tok2->next() : NULL)
+        worklist.startPass();
+        for (Token *tok2 = tok; tok2; tok2 = worklist.next(tok2, done))
         {
+            if (!worklist.visit(tok2, done))
+                continue;
+
             // Delete extra ";"
             while (Token::Match(tok2, "[;{}] ;"))
             {
@@ -2297,6 +2613,7 @@ void CheckMemoryLeakInFunction::simplifycode(Token *tok)
                 if (tok2->str() == "callfunc")
                 {
                     tok2->deleteThis();
+                    worklist.changed(tok2, tok2);
                     done = false;
                 }
             }
@@ -2572,6 +2889,9 @@ void CheckMemoryLeakInFunction::checkReallocUsage()
 
 void CheckMemoryLeakInFunction::parseFunctionScope(const Token *tok, const Token *tok1, const bool classmember)
 {
+    StatementCodeCache cache;
+    statementCodeCache = &cache;
+
     // Check locking/unlocking of global resources..
     checkScope(tok->next(), "", 0, classmember, 1);
 
@@ -2647,6 +2967,8 @@ void CheckMemoryLeakInFunction::parseFunctionScope(const Token *tok, const Token
         }
     }
     while (0 != (tok = tok->next()));
+
+    statementCodeCache = NULL;
 }
 
 void CheckMemoryLeakInFunction::check()
@@ -42,6 +42,7 @@
 #include <vector>
 
 class Token;
+class StatementCodeCache;
 
 /// @addtogroup Core
 /// @{
@@ -166,18 +167,22 @@ public:
  * -# create a simple token list that describes the usage of the function variable.
  * -# simplify the token list.
  * -# finally, check if the simplified token list contain any leaks.
+ *
+ * Most statements of a function don't use a given variable. The token list
+ * for these statements is the same for all the variables of the function,
+ * it is created once and copied.
  */
 
 class CheckMemoryLeakInFunction : private Check, public CheckMemoryLeak
 {
 public:
     /** @brief This constructor is used when registering this class */
-    CheckMemoryLeakInFunction() : Check(myName()), CheckMemoryLeak(0, 0), symbolDatabase(NULL)
+    CheckMemoryLeakInFunction() : Check(myName()), CheckMemoryLeak(0, 0), symbolDatabase(NULL), statementCodeCache(NULL)
     { }
 
     /** @brief This constructor is used when running checks */
     CheckMemoryLeakInFunction(const Tokenizer *tokenizr, const Settings *settings, ErrorLogger *errLog)
-        : Check(myName(), tokenizr, settings, errLog), CheckMemoryLeak(tokenizr, errLog)
+        : Check(myName(), tokenizr, settings, errLog), CheckMemoryLeak(tokenizr, errLog), statementCodeCache(NULL)
     {
         // get the symbol database
         if (tokenizr)
@@ -353,6 +358,12 @@ public:
     std::set<std::string> notnoreturn;
 
     const SymbolDatabase *symbolDatabase;
+
+    /**
+     * The getcode output for the statements of the current function that
+     * don't use the variable. Set by parseFunctionScope.
+     */
+    StatementCodeCache *statementCodeCache;
 };
 
 
@@ -44,6 +44,27 @@ bool CheckNullPointer::isUpper(const std::string &str)
     return true;
 }
 
+// standard functions that dereference first parameter..
+// both uninitialized data and null pointers are invalid.
+static const char * const functionNames1Data[] =
+{
+    "memchr", "memcmp", "strcat", "strncat", "strchr", "strrchr", "strcmp",
+    "strncmp", "strdup", "strndup", "strlen", "strstr", "fclose", "feof",
+    "fwrite", "fseek", "ftell", "fgetpos", "fsetpos", "rewind"
+};
+static const std::set<std::string> functionNames1(functionNames1Data,
+        functionNames1Data + sizeof(functionNames1Data) / sizeof(*functionNames1Data));
+
+// standard functions that dereference second parameter..
+// both uninitialized data and null pointers are invalid.
+static const char * const functionNames2Data[] =
+{
+    "memcmp", "memcpy", "memmove", "strcat", "strncat", "strcmp", "strncmp",
+    "strcpy", "strncpy", "strstr"
+};
+static const std::set<std::string> functionNames2(functionNames2Data,
+        functionNames2Data + sizeof(functionNames2Data) / sizeof(*functionNames2Data));
+
 /**
  * @brief parse a function call and extract information about variable usage
  * @param tok first token
@@ -53,50 +74,6 @@ bool CheckNullPointer::isUpper(const std::string &str)
  */
 void CheckNullPointer::parseFunctionCall(const Token &tok, std::list<const Token *> &var, unsigned char value)
 {
-    // standard functions that dereference first parameter..
-    // both uninitialized data and null pointers are invalid.
-    static std::set<std::string> functionNames1;
-    if (functionNames1.empty())
-    {
-        functionNames1.insert("memchr");
-        functionNames1.insert("memcmp");
-        functionNames1.insert("strcat");
-        functionNames1.insert("strncat");
-        functionNames1.insert("strchr");
-        functionNames1.insert("strrchr");
-        functionNames1.insert("strcmp");
-        functionNames1.insert("strncmp");
-        functionNames1.insert("strdup");
-        functionNames1.insert("strndup");
-        functionNames1.insert("strlen");
-        functionNames1.insert("strstr");
-        functionNames1.insert("fclose");
-        functionNames1.insert("feof");
-        functionNames1.insert("fwrite");
-        functionNames1.insert("fseek");
-        functionNames1.insert("ftell");
-        functionNames1.insert("fgetpos");
-        functionNames1.insert("fsetpos");
-        functionNames1.insert("rewind");
-    }
-
-    // standard functions that dereference second parameter..
-    // both uninitialized data and null pointers are invalid.
-    static std::set<std::string> functionNames2;
-    if (functionNames2.empty())
-    {
-        functionNames2.insert("memcmp");
-        functionNames2.insert("memcpy");
-        functionNames2.insert("memmove");
-        functionNames2.insert("strcat");
-        functionNames2.insert("strncat");
-        functionNames2.insert("strcmp");
-        functionNames2.insert("strncmp");
-        functionNames2.insert("strcpy");
-        functionNames2.insert("strncpy");
-        functionNames2.insert("strstr");
-    }
-
     // 1st parameter..
     if ((Token::Match(&tok, "%var% ( %var% ,|)") && tok.tokAt(2)->varId() > 0) ||
         (value == 0 && Token::Match(&tok, "%var% ( 0 ,|)")))
@@ -990,7 +967,7 @@ void CheckNullPointer::executionPaths()
 {
     // Check for null pointer errors..
     Nullpointer c(this);
-    checkExecutionPaths(_tokenizer->tokens(), &c);
+    checkExecutionPathsDataflow(_tokenizer, &c);
 }
 
 void CheckNullPointer::nullPointerError(const Token *tok)
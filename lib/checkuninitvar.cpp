@@ -1073,12 +1073,13 @@ void CheckUninitVar::executionPaths()
 {
     // check if variable is accessed uninitialized..
     {
-        // no writing if multiple threads are used (TODO: thread safe analysis?)
+        // no writing if multiple threads are used. With -j the functions
+        // of all files are analysed before the checking (--test-2-pass).
         if (_settings->_jobs == 1)
             UninitVar::analyseFunctions(_tokenizer->tokens(), UninitVar::uvarFunctions);
 
         UninitVar c(this);
-        checkExecutionPaths(_tokenizer->tokens(), &c);
+        checkExecutionPaths(_tokenizer, &c);
     }
 }
 
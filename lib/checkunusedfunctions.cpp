@@ -21,9 +21,16 @@
 #include "checkunusedfunctions.h"
 #include "tokenize.h"
 #include "token.h"
+
+#include <sstream>
 //---------------------------------------------------------------------------
 
 
+// Register this check class into cppcheck by creating a static instance of it..
+namespace
+{
+static CheckUnusedFunctions instance;
+}
 
 
 //---------------------------------------------------------------------------
@@ -32,6 +39,15 @@
 
 void CheckUnusedFunctions::parseTokens(const Tokenizer &tokenizer)
 {
+    Summary summary;
+    summarize(tokenizer, summary);
+    merge(summary);
+}
+
+void CheckUnusedFunctions::summarize(const Tokenizer &tokenizer, Summary &summary)
+{
+    summary.filename = tokenizer.getFiles()->at(0);
+
     // Function declarations..
     for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next())
     {
@@ -80,20 +96,7 @@ void CheckUnusedFunctions::parseTokens(const Tokenizer &tokenizer)
         }
 
         if (funcname)
-        {
-            FunctionUsage &func = _functions[ funcname->str()];
-
-            // No filename set yet..
-            if (func.filename.empty())
-                func.filename = tokenizer.getFiles()->at(0);
-
-            // Multiple files => filename = "+"
-            else if (func.filename != tokenizer.getFiles()->at(0))
-            {
-                //func.filename = "+";
-                func.usedOtherFile |= func.usedSameFile;
-            }
-        }
+            summary.defined.push_back(funcname->str());
     }
 
     // Function usage..
@@ -136,16 +139,110 @@ void CheckUnusedFunctions::parseTokens(const Tokenizer &tokenizer)
         }
 
         if (funcname)
-        {
-            FunctionUsage &func = _functions[ funcname->str()];
+            summary.used.push_back(funcname->str());
+    }
+}
 
-            if (func.filename.empty() || func.filename == "+")
-                func.usedOtherFile = true;
+void CheckUnusedFunctions::merge(const Summary &summary)
+{
+    // Function declarations..
+    for (std::vector<std::string>::const_iterator it = summary.defined.begin(); it != summary.defined.end(); ++it)
+    {
+        FunctionUsage &func = _functions[*it];
 
-            else
-                func.usedSameFile = true;
+        // No filename set yet..
+        if (func.filename.empty())
+            func.filename = summary.filename;
+
+        // Multiple files => filename = "+"
+        else if (func.filename != summary.filename)
+        {
+            //func.filename = "+";
+            func.usedOtherFile |= func.usedSameFile;
         }
     }
+
+    // Function usage..
+    for (std::vector<std::string>::const_iterator it = summary.used.begin(); it != summary.used.end(); ++it)
+    {
+        FunctionUsage &func = _functions[*it];
+
+        if (func.filename.empty() || func.filename == "+")
+            func.usedOtherFile = true;
+
+        else
+            func.usedSameFile = true;
+    }
+}
+
+static void serializeNames(std::ostream &oss, const std::vector<std::string> &names)
+{
+    oss << names.size() << " ";
+    for (std::vector<std::string>::const_iterator it = names.begin(); it != names.end(); ++it)
+        oss << it->length() << " " << *it;
+}
+
+std::string CheckUnusedFunctions::serialize(const std::list<Summary> &summaries)
+{
+    // Serialize the summaries into a simple string
+    std::ostringstream oss;
+    oss << summaries.size() << " ";
+    for (std::list<Summary>::const_iterator it = summaries.begin(); it != summaries.end(); ++it)
+    {
+        oss << it->filename.length() << " " << it->filename;
+        serializeNames(oss, it->defined);
+        serializeNames(oss, it->used);
+    }
+    return oss.str();
+}
+
+static bool deserializeString(std::istream &iss, std::string &str)
+{
+    std::string::size_type len = 0;
+    if (!(iss >> len))
+        return false;
+    iss.get();
+
+    str.resize(len);
+    if (len > 0 && !iss.read(&str[0], (std::streamsize)len))
+        return false;
+    return true;
+}
+
+static bool deserializeNames(std::istream &iss, std::vector<std::string> &names)
+{
+    std::vector<std::string>::size_type count = 0;
+    if (!(iss >> count))
+        return false;
+    iss.get();
+
+    names.resize(count);
+    for (std::vector<std::string>::size_type i = 0; i < count; ++i)
+    {
+        if (!deserializeString(iss, names[i]))
+            return false;
+    }
+    return true;
+}
+
+bool CheckUnusedFunctions::deserialize(const std::string &data, std::list<Summary> &summaries)
+{
+    std::istringstream iss(data);
+    std::list<Summary>::size_type count = 0;
+    if (!(iss >> count))
+        return false;
+    iss.get();
+
+    for (std::list<Summary>::size_type i = 0; i < count; ++i)
+    {
+        summaries.push_back(Summary());
+        Summary &summary = summaries.back();
+        if (!deserializeString(iss, summary.filename) ||
+            !deserializeNames(iss, summary.defined) ||
+            !deserializeNames(iss, summary.used))
+            return false;
+    }
+    return true;
 }
 
 
@@ -26,6 +26,11 @@
 #include "tokenize.h"
 #include "errorlogger.h"
 
+#include <list>
+#include <map>
+#include <string>
+#include <vector>
+
 /// @addtogroup Checks
 /// @{
 
@@ -41,11 +46,44 @@ public:
         : Check(myName(), tokenizer, settings, errorLogger)
     { }
 
+    /**
+     * @brief The functions that are defined and used in the code of one
+     * configuration. With -j each worker collects the summaries of its
+     * files and the summaries are merged in file order afterwards.
+     */
+    class Summary
+    {
+    public:
+        /** @brief name of the source file */
+        std::string filename;
+
+        /** @brief names of the defined functions, in token order */
+        std::vector<std::string> defined;
+
+        /** @brief names of the used functions, in token order */
+        std::vector<std::string> used;
+    };
+
     // Parse current tokens and determine..
     // * Check what functions are used
     // * What functions are declared
     void parseTokens(const Tokenizer &tokenizer);
 
+    /** @brief Collect the defined and used functions of the tokens */
+    static void summarize(const Tokenizer &tokenizer, Summary &summary);
+
+    /** @brief Add a summary, parseTokens() = summarize() + merge() */
+    void merge(const Summary &summary);
+
+    /** @brief Serialize summaries into a simple string */
+    static std::string serialize(const std::list<Summary> &summaries);
+
+    /**
+     * @brief Read summaries that were serialized with serialize()
+     * @return false if the data is not valid
+     */
+    static bool deserialize(const std::string &data, std::list<Summary> &summaries);
+
     void check(ErrorLogger * const errorLogger);
 
 private:
@@ -22,13 +22,18 @@
 
 #include "check.h"
 #include "path.h"
+#include "mappedfile.h"
+#include "hash.h"
 
 #include <algorithm>
 #include <iostream>
 #include <fstream>
 #include <stdexcept>
+#include <map>
+#include <set>
 #include <ctime>
 #include "timer.h"
+#include "threading.h"
 
 #ifdef HAVE_RULES
 #define PCRE_STATIC
@@ -37,16 +42,379 @@
 
 static TimerResults S_timerResults;
 
+#ifdef HAVE_RULES
+/**
+ * @brief The --rule patterns are compiled once and then used for all
+ * files and configurations that are checked.
+ */
+class RuleCache
+{
+public:
+    /** @brief A compiled pattern */
+    class CompiledRule
+    {
+    public:
+        CompiledRule() : re(0), extra(0)
+        { }
+
+        /** @brief The compiled pattern, 0 if it could not be compiled */
+        pcre *re;
+
+        /** @brief Result of pcre_study, can be 0 */
+        pcre_extra *extra;
+
+        /** @brief Error from pcre_compile */
+        std::string error;
+    };
+
+    ~RuleCache()
+    {
+        for (std::map<std::string, CompiledRule>::iterator it = _rules.begin(); it != _rules.end(); ++it)
+        {
+#ifdef PCRE_STUDY_JIT_COMPILE
+            if (it->second.extra)
+                pcre_free_study(it->second.extra);
+#else
+            if (it->second.extra)
+                pcre_free(it->second.extra);
+#endif
+            if (it->second.re)
+                pcre_free(it->second.re);
+        }
+    }
+
+    /** @brief Get the compiled pattern, it is compiled the first time */
+    const CompiledRule &get(const std::string &pattern)
+    {
+        Mutex::Lock lock(_mutex);
+
+        std::map<std::string, CompiledRule>::iterator it = _rules.find(pattern);
+        if (it != _rules.end())
+            return it->second;
+
+        CompiledRule &rule = _rules[pattern];
+
+        const char *error = 0;
+        int erroffset = 0;
+        rule.re = pcre_compile(pattern.c_str(), 0, &error, &erroffset, NULL);
+        if (!rule.re)
+        {
+            if (error)
+                rule.error = error;
+            return rule;
+        }
+
+        // Analyse the pattern to make the matching faster
+#ifdef PCRE_STUDY_JIT_COMPILE
+        rule.extra = pcre_study(rule.re, PCRE_STUDY_JIT_COMPILE, &error);
+#else
+        rule.extra = pcre_study(rule.re, 0, &error);
+#endif
+        return rule;
+    }
+
+private:
+    Mutex _mutex;
+    std::map<std::string, CompiledRule> _rules;
+};
+
+static RuleCache S_ruleCache;
+#endif
+
+/**
+ * @brief Forwards everything to another ErrorLogger. The errors are also
+ * recorded so they can be saved in the result cache (--cache-dir).
+ */
+class RecordingErrorLogger : public ErrorLogger
+{
+public:
+    RecordingErrorLogger(ErrorLogger &errorLogger, std::list<ResultCache::Result> *results)
+        : _errorLogger(errorLogger), _results(results)
+    { }
+
+    void reportOut(const std::string &outmsg)
+    {
+        _errorLogger.reportOut(outmsg);
+    }
+
+    void reportErr(const ErrorLogger::ErrorMessage &msg)
+    {
+        if (_results)
+            _results->push_back(ResultCache::Result(true, msg));
+        _errorLogger.reportErr(msg);
+    }
+
+    void reportStatus(unsigned int index, unsigned int max)
+    {
+        _errorLogger.reportStatus(index, max);
+    }
+
+    void reportProgress(const std::string &filename, const char stage[], const unsigned int value)
+    {
+        _errorLogger.reportProgress(filename, stage, value);
+    }
+
+private:
+    ErrorLogger &_errorLogger;
+    std::list<ResultCache::Result> *_results;
+};
+
+/**
+ * @brief The configurations of a file that are left to check. Spare jobs
+ * (see JobSlots) take configurations from the queue too, so several
+ * configurations can be checked at the same time. The errors are passed
+ * on to CppCheck one at a time.
+ */
+class ConfigurationQueue
+{
+public:
+    ConfigurationQueue(CppCheck &cppcheck,
+                       const std::string &filedata,
+                       const std::list<std::string> &configurations,
+                       const std::string &filename,
+                       ErrorLogger &errorLogger,
+                       std::map<std::string, CheckUnusedFunctions::Summary> &usage)
+        : _cppcheck(cppcheck),
+          _filedata(filedata),
+          _configurations(configurations),
+          _next(configurations.begin()),
+          _filename(filename),
+          _errorLogger(errorLogger),
+          _fileTimer(Timer::current()),
+          _usage(usage)
+    { }
+
+    /** @brief Check all configurations, spare jobs help if there are any */
+    void run()
+    {
+        std::vector<Thread *> helpers;
+
+        std::string configuration, code;
+        while (next(configuration, code))
+        {
+            while (helpers.size() + 1 < _configurations.size() &&
+                   !done() &&
+                   JobSlots::acquire())
+            {
+                Thread *thread = new Thread;
+                if (!thread->start(helper, this))
+                {
+                    delete thread;
+                    JobSlots::release(1);
+                    break;
+                }
+                helpers.push_back(thread);
+            }
+
+            check(code, configuration);
+        }
+
+        // Wait for the helpers
+        for (std::vector<Thread *>::iterator it = helpers.begin(); it != helpers.end(); ++it)
+            delete *it;
+
+        if (!_error.empty())
+            throw std::runtime_error(_error);
+    }
+
+    void reportOut(const std::string &outmsg)
+    {
+        Mutex::Lock lock(_mutex);
+        _cppcheck.reportOut(outmsg);
+    }
+
+    void reportErr(const ErrorLogger::ErrorMessage &msg, const std::string &configuration)
+    {
+        Mutex::Lock lock(_mutex);
+        _cppcheck.reportErr(msg, configuration);
+    }
+
+    void reportProgress(const std::string &filename, const char stage[], const unsigned int value)
+    {
+        Mutex::Lock lock(_mutex);
+        _cppcheck.reportProgress(filename, stage, value);
+    }
+
+private:
+    /** @brief Passes the errors of one configuration on to the queue */
+    class ConfigurationErrorLogger : public ErrorLogger
+    {
+    public:
+        ConfigurationErrorLogger(ConfigurationQueue &queue, const std::string &configuration)
+            : _queue(queue), _configuration(configuration)
+        { }
+
+        void reportOut(const std::string &outmsg)
+        {
+            _queue.reportOut(outmsg);
+        }
+
+        void reportErr(const ErrorLogger::ErrorMessage &msg)
+        {
+            _queue.reportErr(msg, _configuration);
+        }
+
+        void reportStatus(unsigned int /*index*/, unsigned int /*max*/)
+        {
+        }
+
+        void reportProgress(const std::string &filename, const char stage[], const unsigned int value)
+        {
+            _queue.reportProgress(filename, stage, value);
+        }
+
+    private:
+        ConfigurationQueue &_queue;
+        const std::string &_configuration;
+    };
+
+    /** @brief Thread function of a spare job */
+    static void helper(void *queue)
+    {
+        ConfigurationQueue *configurationQueue = static_cast<ConfigurationQueue *>(queue);
+
+        std::string configuration, code;
+        while (configurationQueue->next(configuration, code))
+            configurationQueue->check(code, configuration);
+
+        JobSlots::release(1);
+    }
+
+    /**
+     * @brief Check a configuration. If the checking fails the remaining
+     * configurations are not checked and run() throws the error.
+     */
+    void check(const std::string &code, const std::string &configuration)
+    {
+        CheckUnusedFunctions::Summary usage;
+        try
+        {
+            ConfigurationErrorLogger errorLogger(*this, configuration);
+            Timer t("CppCheck::checkFile", _cppcheck._settings._showtime, &S_timerResults, _fileTimer);
+            _cppcheck.checkFile(code, _filename.c_str(), configuration, errorLogger, usage);
+        }
+        catch (std::runtime_error &e)
+        {
+            Mutex::Lock lock(_mutex);
+            if (_error.empty())
+                _error = e.what();
+            _next = _configurations.end();
+        }
+
+        Mutex::Lock lock(_mutex);
+        _usage[configuration] = usage;
+    }
+
+    /** @brief Are all configurations taken? */
+    bool done()
+    {
+        Mutex::Lock lock(_mutex);
+        return _next == _configurations.end();
+    }
+
+    /**
+     * @brief Take the next configuration. Configurations whose code is
+     * the same as the code of a configuration that is already taken are
+     * skipped, the results would be the same.
+     * @param configuration the configuration
+     * @param code the code for the configuration
+     * @return false if all configurations are taken
+     */
+    bool next(std::string &configuration, std::string &code)
+    {
+        Mutex::Lock lock(_mutex);
+        for (;;)
+        {
+            if (_next == _configurations.end() || _cppcheck._settings.terminated())
+                return false;
+
+            configuration = *_next;
+
+            Timer t("Preprocessor::getcode", _cppcheck._settings._showtime, &S_timerResults, _fileTimer);
+            code = Preprocessor::getcode(_filedata, configuration, _filename, &_cppcheck._settings, &_errorLogger);
+            t.Stop();
+
+            // If only errors are printed, print filename after the check
+            if (_cppcheck._settings._errorsOnly == false && _next != _configurations.begin())
+            {
+                std::string fixedpath = Path::simplifyPath(_filename.c_str());
+                fixedpath = Path::toNativeSeparators(fixedpath);
+                _errorLogger.reportOut(std::string("Checking ") + fixedpath + ": " + configuration + std::string("..."));
+            }
+
+            std::string appendCode = _cppcheck._settings.append();
+            if (!appendCode.empty())
+                Preprocessor::preprocessWhitespaces(appendCode);
+            code += appendCode;
+
+            ++_next;
+
+            if (_checkedCode.insert(std::make_pair(code.length(), fnv1aHash(code))).second)
+                return true;
+        }
+    }
+
+    CppCheck &_cppcheck;
+    const std::string &_filedata;
+    const std::list<std::string> &_configurations;
+    std::list<std::string>::const_iterator _next;
+    const std::string &_filename;
+
+    /** @brief errors that are not filtered by CppCheck */
+    ErrorLogger &_errorLogger;
+
+    /** @brief timer of the file, the timers of the configurations are nested in it */
+    const Timer *_fileTimer;
+
+    /** @brief error that stopped the checking */
+    std::string _error;
+
+    /** @brief length and hash of the code that is taken */
+    std::set<std::pair<std::string::size_type, unsigned long long> > _checkedCode;
+
+    /** @brief functions defined and used in each checked configuration */
+    std::map<std::string, CheckUnusedFunctions::Summary> &_usage;
+
+    Mutex _mutex;
+
+    // Not implemented..
+    ConfigurationQueue(const ConfigurationQueue &);
+    void operator=(const ConfigurationQueue &);
+};
+
+/**
+ * @brief Move the functions that are defined and used in the checked
+ * configurations to a list, in configuration order.
+ * @param configurations the configurations of the file
+ * @param usage the functions of each checked configuration, cleared
+ * @param fileUsage the functions are added here
+ */
+static void takeUsage(const std::list<std::string> &configurations,
+                      std::map<std::string, CheckUnusedFunctions::Summary> &usage,
+                      std::list<CheckUnusedFunctions::Summary> &fileUsage)
+{
+    for (std::list<std::string>::const_iterator it = configurations.begin(); it != configurations.end(); ++it)
+    {
+        const std::map<std::string, CheckUnusedFunctions::Summary>::const_iterator summary = usage.find(*it);
+        if (summary != usage.end())
+            fileUsage.push_back(summary->second);
+    }
+    usage.clear();
+}
+
 CppCheck::CppCheck(ErrorLogger &errorLogger, bool useGlobalSuppressions)
-    : _useGlobalSuppressions(useGlobalSuppressions), _errorLogger(errorLogger)
+    : _useGlobalSuppressions(useGlobalSuppressions), _checkUnusedFunctions(0, &_settings, this), _errorLogger(errorLogger), _recordResults(false)
 {
     exitcode = 0;
 }
 
 CppCheck::~CppCheck()
 {
-    if (_settings._showtime != SHOWTIME_NONE)
-        S_timerResults.ShowResults();
+}
+
+TimerResults &CppCheck::timerResults()
+{
+    return S_timerResults;
 }
 
 void CppCheck::settings(const Settings &currentSettings)
@@ -79,6 +447,7 @@ const char * CppCheck::version()
 unsigned int CppCheck::check()
 {
     exitcode = 0;
+    _usageSummaries.clear();
 
     std::sort(_filenames.begin(), _filenames.end());
 
@@ -116,10 +485,15 @@ unsigned int CppCheck::check()
             _errorLogger.reportOut(std::string("Checking ") + fixedpath + std::string("..."));
         }
 
+        std::list<std::string> configurations;
+        std::map<std::string, CheckUnusedFunctions::Summary> usage;
+        std::list<CheckUnusedFunctions::Summary> fileUsage;
+
         try
         {
+            Timer fileTimer("CppCheck::check", _settings._showtime, &S_timerResults);
+
             Preprocessor preprocessor(&_settings, this);
-            std::list<std::string> configurations;
             std::string filedata = "";
 
             if (_fileContents.size() > 0 && _fileContents.find(_filenames[c]) != _fileContents.end())
@@ -131,9 +505,10 @@ unsigned int CppCheck::check()
             else
             {
                 // Only file name was given, read the content from file
-                std::ifstream fin(fname.c_str());
+                MappedFile fin;
+                fin.open(fname);
                 Timer t("Preprocessor::preprocess", _settings._showtime, &S_timerResults);
-                preprocessor.preprocess(fin, filedata, configurations, fname, _settings._includePaths);
+                preprocessor.preprocess(fin.data(), fin.size(), filedata, configurations, fname, _settings._includePaths);
             }
 
             _settings.ifcfg = bool(configurations.size() > 1);
@@ -144,51 +519,73 @@ unsigned int CppCheck::check()
                 configurations.push_back(_settings.userDefines);
             }
 
-            int checkCount = 0;
-            for (std::list<std::string>::const_iterator it = configurations.begin(); it != configurations.end(); ++it)
+            // With --test-2-pass the results depend on the other files.
+            // The functions that the file defines and uses are saved with
+            // the results, the unused functions check doesn't need the tokens.
+            const bool useCache = !_settings._cacheDir.empty() && !_settings.test_2_pass;
+            const bool saveUsage = _settings.isEnabled("unusedFunction");
+            const ResultCache cache(_settings._cacheDir);
+            std::string cacheKey;
+            if (useCache)
             {
-                // Check only 12 first configurations, after that bail out, unless --force
-                // was used.
-                if (!_settings._force && checkCount > 11)
+                cacheKey = ResultCache::key(_settings, fname, filedata, configurations);
+
+                std::list<ResultCache::Result> results;
+                if (cache.load(cacheKey, fname, results, saveUsage ? &fileUsage : 0))
                 {
-                    const std::string fixedpath = Path::toNativeSeparators(fname);
-                    ErrorLogger::ErrorMessage::FileLocation location;
-                    location.setfile(fixedpath);
-                    std::list<ErrorLogger::ErrorMessage::FileLocation> loclist;
-                    loclist.push_back(location);
-                    const std::string msg("Interrupted checking because of too many #ifdef configurations.\n"
-                                          "The checking of the file was interrupted because there were too many "
-                                          "#ifdef configurations. Checking of all #ifdef configurations can be forced "
-                                          "by --force command line option or from GUI preferences. However that may "
-                                          "increase the checking time.");
-                    ErrorLogger::ErrorMessage errmsg(loclist,
-                                                     Severity::information,
-                                                     msg,
-                                                     "toomanyconfigs");
-                    _errorLogger.reportErr(errmsg);
-                    break;
+                    // Report the saved results instead of checking the configurations
+                    configurations.clear();
+                    for (std::list<ResultCache::Result>::const_iterator it = results.begin(); it != results.end(); ++it)
+                    {
+                        if (it->_direct)
+                            _errorLogger.reportErr(it->_msg);
+                        else
+                            reportErr(it->_msg);
+                    }
                 }
-
-                cfg = *it;
-                Timer t("Preprocessor::getcode", _settings._showtime, &S_timerResults);
-                const std::string codeWithoutCfg = Preprocessor::getcode(filedata, *it, fname, &_settings, &_errorLogger);
-                t.Stop();
-
-                // If only errors are printed, print filename after the check
-                if (_settings._errorsOnly == false && it != configurations.begin())
+                else
                 {
-                    std::string fixedpath = Path::simplifyPath(fname.c_str());
-                    fixedpath = Path::toNativeSeparators(fixedpath);
-                    _errorLogger.reportOut(std::string("Checking ") + fixedpath + ": " + cfg + std::string("..."));
+                    _recordResults = true;
+                    _results.clear();
                 }
+            }
+            RecordingErrorLogger errorLogger(_errorLogger, _recordResults ? &_results : 0);
+
+            // Check only 12 first configurations, after that bail out, unless --force
+            // was used.
+            bool tooManyConfigs = false;
+            if (!_settings._force && configurations.size() > 12)
+            {
+                configurations.resize(12);
+                tooManyConfigs = true;
+            }
 
-                std::string appendCode = _settings.append();
-                if (!appendCode.empty())
-                    Preprocessor::preprocessWhitespaces(appendCode);
+            ConfigurationQueue queue(*this, filedata, configurations, fname, errorLogger, usage);
+            queue.run();
+            takeUsage(configurations, usage, fileUsage);
 
-                checkFile(codeWithoutCfg + appendCode, _filenames[c].c_str());
-                ++checkCount;
+            if (tooManyConfigs)
+            {
+                const std::string fixedpath = Path::toNativeSeparators(fname);
+                ErrorLogger::ErrorMessage::FileLocation location;
+                location.setfile(fixedpath);
+                std::list<ErrorLogger::ErrorMessage::FileLocation> loclist;
+                loclist.push_back(location);
+                const std::string msg("Interrupted checking because of too many #ifdef configurations.\n"
+                                      "The checking of the file was interrupted because there were too many "
+                                      "#ifdef configurations. Checking of all #ifdef configurations can be forced "
+                                      "by --force command line option or from GUI preferences. However that may "
+                                      "increase the checking time.");
+                ErrorLogger::ErrorMessage errmsg(loclist,
+                                                 Severity::information,
+                                                 msg,
+                                                 "toomanyconfigs");
+                errorLogger.reportErr(errmsg);
             }
+
+            // Save the results unless the checking was interrupted
+            if (_recordResults && !_settings.terminated())
+                cache.save(cacheKey, fname, _results, saveUsage ? &fileUsage : 0);
         }
         catch (std::runtime_error &e)
         {
@@ -197,6 +594,22 @@ unsigned int CppCheck::check()
             _errorLogger.reportOut("Bailing out from checking " + fixedpath + ": " + e.what());
         }
 
+        _recordResults = false;
+        _results.clear();
+
+        // The functions that are defined and used, in configuration order.
+        // With -j they are merged by the executor when all files are checked.
+        takeUsage(configurations, usage, fileUsage);
+        if (_settings._jobs == 1)
+        {
+            for (std::list<CheckUnusedFunctions::Summary>::const_iterator it = fileUsage.begin(); it != fileUsage.end(); ++it)
+                _checkUnusedFunctions.merge(*it);
+        }
+        else
+        {
+            _usageSummaries.splice(_usageSummaries.end(), fileUsage);
+        }
+
         reportUnmatchedSuppressions(_settings.nomsg.getUnmatchedLocalSuppressions(fname));
 
         _errorLogger.reportStatus(c + 1, (unsigned int)_filenames.size());
@@ -205,7 +618,7 @@ unsigned int CppCheck::check()
     // This generates false positives - especially for libraries
     const bool verbose_orig = _settings._verbose;
     _settings._verbose = false;
-    if (_settings.isEnabled("unusedFunctions") && _settings._jobs == 1)
+    if (_settings.isEnabled("unusedFunction") && _settings._jobs == 1)
     {
         _errout.str("");
         if (_settings._errorsOnly == false)
@@ -220,12 +633,35 @@ unsigned int CppCheck::check()
 }
 
 void CppCheck::analyseFile(std::istream &fin, const std::string &filename)
+{
+    std::set<std::string> data;
+    analyseFile(fin, filename, data);
+
+    // Save analysis results..
+    for (std::list<Check *>::const_iterator it = Check::instances().begin(); it != Check::instances().end(); ++it)
+    {
+        (*it)->saveAnalysisData(data);
+    }
+}
+
+void CppCheck::analyseFile(std::istream &fin, const std::string &filename, std::set<std::string> &data)
 {
     // Preprocess file..
     Preprocessor preprocessor(&_settings, this);
     std::list<std::string> configurations;
     std::string filedata = "";
     preprocessor.preprocess(fin, filedata, configurations, filename, _settings._includePaths);
+
+    // Reuse the saved analysis data if the file has not changed
+    const ResultCache cache(_settings._cacheDir);
+    std::string cacheKey;
+    if (!_settings._cacheDir.empty())
+    {
+        cacheKey = ResultCache::key(_settings, filename, filedata, std::list<std::string>());
+        if (cache.loadAnalysis(cacheKey, filename, data))
+            return;
+    }
+
     const std::string code = Preprocessor::getcode(filedata, "", filename, &_settings, &_errorLogger);
 
     // Tokenize..
@@ -235,38 +671,34 @@ void CppCheck::analyseFile(std::istream &fin, const std::string &filename)
     tokenizer.simplifyTokenList();
 
     // Analyse the tokens..
-    std::set<std::string> data;
+    std::set<std::string> fileData;
     for (std::list<Check *>::const_iterator it = Check::instances().begin(); it != Check::instances().end(); ++it)
     {
-        (*it)->analyse(tokenizer.tokens(), data);
+        (*it)->analyse(tokenizer.tokens(), fileData);
     }
 
-    // Save analysis results..
-    // TODO: This loop should be protected by a mutex or something like that
-    //       The saveAnalysisData must _not_ be called from many threads at the same time.
-    for (std::list<Check *>::const_iterator it = Check::instances().begin(); it != Check::instances().end(); ++it)
-    {
-        (*it)->saveAnalysisData(data);
-    }
+    if (!_settings._cacheDir.empty() && !_settings.terminated())
+        cache.saveAnalysis(cacheKey, filename, fileData);
+    data.insert(fileData.begin(), fileData.end());
 }
 
 //---------------------------------------------------------------------------
 // CppCheck - A function that checks a specified file
 //---------------------------------------------------------------------------
 
-void CppCheck::checkFile(const std::string &code, const char FileName[])
+void CppCheck::checkFile(const std::string &code, const char FileName[], const std::string &configuration, ErrorLogger &errorLogger, CheckUnusedFunctions::Summary &usage)
 {
     if (_settings.terminated())
         return;
 
-    Tokenizer _tokenizer(&_settings, this);
+    Tokenizer _tokenizer(&_settings, &errorLogger);
     bool result;
 
     // Tokenize the file
     std::istringstream istr(code);
 
     Timer timer("Tokenizer::tokenize", _settings._showtime, &S_timerResults);
-    result = _tokenizer.tokenize(istr, FileName, cfg);
+    result = _tokenizer.tokenize(istr, FileName, configuration);
     timer.Stop();
     if (!result)
     {
@@ -285,7 +717,7 @@ void CppCheck::checkFile(const std::string &code, const char FileName[])
             return;
 
         Timer timerRunChecks((*it)->name() + "::runChecks", _settings._showtime, &S_timerResults);
-        (*it)->runChecks(&_tokenizer, &_settings, this);
+        (*it)->runChecks(&_tokenizer, &_settings, &errorLogger);
     }
 
     Timer timer3("Tokenizer::simplifyTokenList", _settings._showtime, &S_timerResults);
@@ -298,8 +730,8 @@ void CppCheck::checkFile(const std::string &code, const char FileName[])
     _tokenizer.fillFunctionList();
     timer4.Stop();
 
-    if (_settings.isEnabled("unusedFunctions") && _settings._jobs == 1)
-        _checkUnusedFunctions.parseTokens(_tokenizer);
+    if (_settings.isEnabled("unusedFunction"))
+        CheckUnusedFunctions::summarize(_tokenizer, usage);
 
     // call all "runSimplifiedChecks" in all registered Check classes
     for (std::list<Check *>::iterator it = Check::instances().begin(); it != Check::instances().end(); ++it)
@@ -308,41 +740,47 @@ void CppCheck::checkFile(const std::string &code, const char FileName[])
             return;
 
         Timer timerSimpleChecks((*it)->name() + "::runSimplifiedChecks", _settings._showtime, &S_timerResults);
-        (*it)->runSimplifiedChecks(&_tokenizer, &_settings, this);
+        (*it)->runSimplifiedChecks(&_tokenizer, &_settings, &errorLogger);
     }
 
 #ifdef HAVE_RULES
     // Are there extra rules?
     if (!_settings.rules.empty())
     {
-        std::ostringstream ostr;
+        // The text of the tokens. The text of tokens[i] ends at ends[i]
+        std::string str;
+        std::vector<const Token *> tokens;
+        std::vector<std::string::size_type> ends;
         for (const Token *tok = _tokenizer.tokens(); tok; tok = tok->next())
-            ostr << " " << tok->str();
-        const std::string str(ostr.str());
+        {
+            str += " ";
+            str += tok->str();
+            tokens.push_back(tok);
+            ends.push_back(str.size());
+        }
+
         for (std::list<Settings::Rule>::const_iterator it = _settings.rules.begin(); it != _settings.rules.end(); ++it)
         {
             const Settings::Rule &rule = *it;
             if (rule.pattern.empty() || rule.id.empty() || rule.severity.empty())
                 continue;
 
-            const char *error = 0;
-            int erroffset = 0;
-            pcre *re = pcre_compile(rule.pattern.c_str(),0,&error,&erroffset,NULL);
-            if (!re && error)
+            const RuleCache::CompiledRule &compiled = S_ruleCache.get(rule.pattern);
+            if (!compiled.re && !compiled.error.empty())
             {
                 ErrorLogger::ErrorMessage errmsg(std::list<ErrorLogger::ErrorMessage::FileLocation>(),
                                                  Severity::error,
-                                                 error,
+                                                 compiled.error,
                                                  "pcre_compile");
 
-                reportErr(errmsg);
+                errorLogger.reportErr(errmsg);
             }
-            if (!re)
+            if (!compiled.re)
                 continue;
 
             int pos = 0;
             int ovector[30];
-            while (0 <= pcre_exec(re, NULL, str.c_str(), (int)str.size(), pos, 0, ovector, 30))
+            while (0 <= pcre_exec(compiled.re, compiled.extra, str.c_str(), (int)str.size(), pos, 0, ovector, 30))
             {
                 unsigned int pos1 = (unsigned int)ovector[0];
                 unsigned int pos2 = (unsigned int)ovector[1];
@@ -355,16 +793,12 @@ void CppCheck::checkFile(const std::string &code, const char FileName[])
                 loc.setfile(_tokenizer.getFiles()->front());
                 loc.line = 0;
 
-                unsigned int len = 0;
-                for (const Token *tok = _tokenizer.tokens(); tok; tok = tok->next())
+                const std::vector<std::string::size_type>::const_iterator end = std::upper_bound(ends.begin(), ends.end(), pos1);
+                if (end != ends.end())
                 {
-                    len = len + 1 + tok->str().size();
-                    if (len > pos1)
-                    {
-                        loc.setfile(_tokenizer.getFiles()->at(tok->fileIndex()));
-                        loc.line = tok->linenr();
-                        break;
-                    }
+                    const Token *tok = tokens[end - ends.begin()];
+                    loc.setfile(_tokenizer.getFiles()->at(tok->fileIndex()));
+                    loc.line = tok->linenr();
                 }
 
                 const std::list<ErrorLogger::ErrorMessage::FileLocation> callStack(1, loc);
@@ -378,10 +812,8 @@ void CppCheck::checkFile(const std::string &code, const char FileName[])
                 ErrorLogger::ErrorMessage errmsg(callStack, Severity::fromString(rule.severity), summary, rule.id);
 
                 // Report error
-                reportErr(errmsg);
+                errorLogger.reportErr(errmsg);
             }
-
-            pcre_free(re);
         }
     }
 #endif
@@ -396,10 +828,17 @@ Settings &CppCheck::settings()
 
 void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg)
 {
-    std::string errmsg = msg.toString(_settings._verbose);
+    reportErr(msg, "");
+}
+
+void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg, const std::string &configuration)
+{
+    if (_recordResults)
+        _results.push_back(ResultCache::Result(false, msg));
 
     // Alert only about unique errors
-    if (std::find(_errorList.begin(), _errorList.end(), errmsg) != _errorList.end())
+    const ReportedErrors::Fingerprint fingerprint(ReportedErrors::fingerprint(msg, _settings._verbose));
+    if (_errorList.contains(fingerprint))
         return;
 
     std::string file;
@@ -424,11 +863,11 @@ void CppCheck::reportErr(const ErrorLogger::ErrorMessage &msg)
     if (!_settings.nofail.isSuppressed(msg._id, file, line))
         exitcode = 1;
 
-    _errorList.push_back(errmsg);
-    std::string errmsg2(errmsg);
+    _errorList.insert(fingerprint);
+    std::string errmsg2(msg.toString(_settings._verbose));
     if (_settings._verbose)
     {
-        errmsg2 += "\n    Defines=\'" + cfg + "\'\n";
+        errmsg2 += "\n    Defines=\'" + configuration + "\'\n";
     }
 
     _errorLogger.reportErr(msg);
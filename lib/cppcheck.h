@@ -22,9 +22,12 @@
 #include "settings.h"
 #include "errorlogger.h"
 #include "checkunusedfunctions.h"
+#include "resultcache.h"
+#include "timer.h"
 
 #include <string>
 #include <list>
+#include <set>
 #include <sstream>
 #include <vector>
 
@@ -118,14 +121,47 @@ public:
      */
     void getErrorMessages();
 
+    /**
+     * @brief The timing results of all CppCheck instances (--showtime)
+     */
+    static TimerResults &timerResults();
+
     /**
      * @brief Analyse file - It's public so unit tests can be written
      */
     void analyseFile(std::istream &f, const std::string &filename);
 
+    /**
+     * @brief Analyse file without saving the analysis data. With -j the
+     * workers collect the data of the files and it is saved once.
+     * @param f the file
+     * @param filename name of the file
+     * @param data the analysis data of the file is added here
+     */
+    void analyseFile(std::istream &f, const std::string &filename, std::set<std::string> &data);
+
+    /**
+     * @brief Functions defined and used in the checked files. With -j
+     * the unused functions are not checked by each worker, the summaries
+     * of all workers are merged in file order instead.
+     */
+    const std::list<CheckUnusedFunctions::Summary> &usageSummaries() const
+    {
+        return _usageSummaries;
+    }
+
 private:
-    /** @brief Check file */
-    void checkFile(const std::string &code, const char FileName[]);
+    /**
+     * @brief Check the code of a configuration
+     * @param code preprocessed code
+     * @param FileName name of the source file
+     * @param configuration the configuration, e.g. "A;B"
+     * @param errorLogger the errors are reported here
+     * @param usage the defined and used functions are collected here
+     */
+    void checkFile(const std::string &code, const char FileName[], const std::string &configuration, ErrorLogger &errorLogger, CheckUnusedFunctions::Summary &usage);
+
+    friend class ConfigurationQueue;
 
     /**
      * @brief Errors and warnings are directed here.
@@ -136,6 +172,13 @@ private:
      */
     virtual void reportErr(const ErrorLogger::ErrorMessage &msg);
 
+    /**
+     * @brief Errors and warnings of a configuration are directed here.
+     * @param msg the error message
+     * @param configuration the configuration that was checked, e.g. "A;B"
+     */
+    void reportErr(const ErrorLogger::ErrorMessage &msg, const std::string &configuration);
+
     /**
      * @brief Information about progress is directed here.
      *
@@ -144,7 +187,7 @@ private:
     virtual void reportOut(const std::string &outmsg);
 
     unsigned int exitcode;
-    std::list<std::string> _errorList;
+    ReportedErrors _errorList;
     std::ostringstream _errout;
     Settings _settings;
     bool _useGlobalSuppressions;
@@ -156,10 +199,17 @@ private:
     std::map<std::string, std::string> _fileContents;
 
     CheckUnusedFunctions _checkUnusedFunctions;
+
+    /** @brief Defined and used functions of the checked files when -j is used */
+    std::list<CheckUnusedFunctions::Summary> _usageSummaries;
+
     ErrorLogger &_errorLogger;
 
-    /** @brief Current preprocessor configuration */
-    std::string     cfg;
+    /** @brief Errors reported for the current file are recorded for the result cache (--cache-dir) */
+    bool _recordResults;
+
+    /** @brief Errors reported for the current file */
+    std::list<ResultCache::Result> _results;
 };
 
 /// @}
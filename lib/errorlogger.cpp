@@ -19,6 +19,7 @@
 #include "errorlogger.h"
 #include "path.h"
 #include "cppcheck.h"
+#include "hash.h"
 
 #include <sstream>
 #include <vector>
@@ -115,7 +116,7 @@ bool ErrorLogger::ErrorMessage::deserialize(const std::string &data)
     if (!(iss >> stackSize))
         return false;
 
-    while (iss.good())
+    while (iss.good() && _callStack.size() < stackSize)
     {
         unsigned int len = 0;
         if (!(iss >> len))
@@ -315,6 +316,18 @@ std::string ErrorLogger::callStackToString(const std::list<ErrorLogger::ErrorMes
 }
 
 
+ReportedErrors::Fingerprint ReportedErrors::fingerprint(const ErrorLogger::ErrorMessage &msg, bool verbose)
+{
+    std::ostringstream text;
+    text << msg._id << '\0' << msg._severity << '\0';
+    for (std::list<ErrorLogger::ErrorMessage::FileLocation>::const_iterator loc = msg._callStack.begin(); loc != msg._callStack.end(); ++loc)
+        text << loc->getfile(false) << ':' << loc->line << '\0';
+    text << (verbose ? msg.verboseMessage() : msg.shortMessage());
+
+    const std::string str(text.str());
+    return Fingerprint(fnv1aHash(str), str);
+}
+
 std::string ErrorLogger::ErrorMessage::FileLocation::getfile(bool convert) const
 {
     std::string f = Path::simplifyPath(_file.c_str());
@@ -21,7 +21,9 @@
 #define errorloggerH
 
 #include <list>
+#include <set>
 #include <string>
+#include <utility>
 
 #include "settings.h"
 
@@ -280,7 +282,8 @@ public:
     virtual void reportStatus(unsigned int index, unsigned int max) = 0;
 
     /**
-     * Report progress to client
+     * Report progress to client. A ProgressReporter calls this from
+     * its own thread with the progress of the running stages.
      * @param filename main file that is checked
      * @param stage for example preprocess / tokenize / simplify / check
      * @param value progress value (0-100)
@@ -301,6 +304,48 @@ public:
     static std::string callStackToString(const std::list<ErrorLogger::ErrorMessage::FileLocation> &callStack);
 };
 
+/**
+ * @brief Errors that have been reported. Used to report each error only
+ * once. The errors are ordered by a hash of their fingerprint so the
+ * lookup stays fast when there are many errors.
+ */
+class ReportedErrors
+{
+public:
+    /** @brief Hash and text that identifies an error */
+    typedef std::pair<unsigned long long, std::string> Fingerprint;
+
+    /**
+     * @brief Get the fingerprint of an error: id, severity, call stack and message.
+     * @param msg the error
+     * @param verbose use the verbose message
+     */
+    static Fingerprint fingerprint(const ErrorLogger::ErrorMessage &msg, bool verbose);
+
+    /** @brief Has the error been reported? */
+    bool contains(const Fingerprint &fingerprint) const
+    {
+        return bool(_errors.find(fingerprint) != _errors.end());
+    }
+
+    /**
+     * @brief Add reported error.
+     * @return false if the error was already reported
+     */
+    bool insert(const Fingerprint &fingerprint)
+    {
+        return _errors.insert(fingerprint).second;
+    }
+
+    void clear()
+    {
+        _errors.clear();
+    }
+
+private:
+    std::set<Fingerprint> _errors;
+};
+
 
 /// @}
 
@@ -19,8 +19,11 @@
 
 #include "executionpath.h"
 #include "token.h"
+#include "tokenize.h"
+#include <map>
 #include <memory>
 #include <set>
+#include <vector>
 #include <iterator>
 #include <iostream>
 
@@ -139,265 +142,289 @@ static void parseIfSwitchBody(const Token * const tok,
 }
 
 
-void ExecutionPath::checkScope(const Token *tok, std::list<ExecutionPath *> &checks)
+/**
+ * @brief Parse a token in code that doesn't branch. The bodies of loops
+ * are not parsed, the variables that are used in them are bailed out.
+ * @param check the check
+ * @param tok the token to parse
+ * @param checks the execution paths
+ * @return the last parsed token. 0 => the checking of the scope ends.
+ */
+static const Token *parseToken(ExecutionPath &check, const Token *tok, std::list<ExecutionPath *> &checks)
 {
-    if (!tok || tok->str() == "}" || checks.empty())
-        return;
-
-    const std::auto_ptr<ExecutionPath> check(checks.front()->copy());
-
-    for (; tok; tok = tok->next())
+    if (Token::simpleMatch(tok, "while ("))
     {
-        // might be a noreturn function..
-        if (Token::simpleMatch(tok->tokAt(-2), ") ; }") &&
-            Token::Match(tok->tokAt(-2)->link()->tokAt(-2), "[;{}] %var% (") &&
-            tok->tokAt(-2)->link()->previous()->varId() == 0)
+        // parse condition
+        if (check.parseCondition(*tok->tokAt(2), checks))
         {
             ExecutionPath::bailOut(checks);
-            return;
+            return 0;
         }
 
-        if (tok->str() == "}" || tok->str() == "break")
-            return;
-
-        if (Token::simpleMatch(tok, "while ("))
+        // skip "while (fgets()!=NULL)"
+        if (Token::simpleMatch(tok, "while ( fgets ("))
         {
-            // parse condition
-            if (checks.size() > 10 || check->parseCondition(*tok->tokAt(2), checks))
-            {
-                ExecutionPath::bailOut(checks);
-                return;
-            }
-
-            // skip "while (fgets()!=NULL)"
-            if (Token::simpleMatch(tok, "while ( fgets ("))
-            {
-                const Token *tok2 = tok->tokAt(3)->link();
-                if (Token::simpleMatch(tok2, ") ) {"))
-                {
-                    tok = tok2->tokAt(2)->link();
-                    if (!tok)
-                        break;
-                    continue;
-                }
-            }
+            const Token *tok2 = tok->tokAt(3)->link();
+            if (Token::simpleMatch(tok2, ") ) {"))
+                return tok2->tokAt(2)->link();
         }
+    }
+
+    // goto/setjmp/longjmp => bailout
+    if (Token::Match(tok, "goto|setjmp|longjmp"))
+    {
+        ExecutionPath::bailOut(checks);
+        return 0;
+    }
 
-        // goto/setjmp/longjmp => bailout
-        if (Token::Match(tok, "goto|setjmp|longjmp"))
+    // ?: => bailout
+    if (tok->str() == "?")
+    {
+        for (const Token *tok2 = tok; tok2 && tok2->str() != ";"; tok2 = tok2->next())
         {
-            ExecutionPath::bailOut(checks);
-            return;
+            if (tok2->varId() > 0)
+                ExecutionPath::bailOutVar(checks, tok2->varId());
         }
+    }
 
-        // ?: => bailout
-        if (tok->str() == "?")
+    // for/while/switch/do .. bail out
+    if (Token::Match(tok, "for|while|switch|do"))
+    {
+        // goto {
+        const Token *tok2 = tok->next();
+        if (tok2 && tok2->str() == "(")
+            tok2 = tok2->link();
+        if (tok2 && tok2->str() == ")")
+            tok2 = tok2->next();
+        if (!tok2 || tok2->str() != "{")
         {
-            for (const Token *tok2 = tok; tok2 && tok2->str() != ";"; tok2 = tok2->next())
-            {
-                if (tok2->varId() > 0)
-                    ExecutionPath::bailOutVar(checks, tok2->varId());
-            }
+            ExecutionPath::bailOut(checks);
+            return 0;
         }
 
-        if (tok->str() == "switch")
+        if (tok->str() != "switch")
         {
-            // parse condition
-            if (checks.size() > 10 || check->parseCondition(*tok->next(), checks))
+            for (const Token *tok3 = tok; tok3 && tok3 != tok2; tok3 = tok3->next())
             {
-                ExecutionPath::bailOut(checks);
-                return;
-            }
-
-            const Token *tok2 = tok->next()->link();
-            if (Token::simpleMatch(tok2, ") { case"))
-            {
-                // what variable ids should the if be counted for?
-                std::set<unsigned int> countif;
-
-                std::list<ExecutionPath *> newchecks;
-
-                for (tok2 = tok2->tokAt(2); tok2; tok2 = tok2->next())
-                {
-                    if (tok2->str() == "{")
-                        tok2 = tok2->link();
-                    else if (tok2->str() == "}")
-                        break;
-                    else if (tok2->str() == "case" &&
-                             !Token::Match(tok2, "case %num% : ; case"))
-                    {
-                        parseIfSwitchBody(tok2, checks, newchecks, countif);
-                    }
-                }
-
-                // Add newchecks to checks..
-                std::copy(newchecks.begin(), newchecks.end(), std::back_inserter(checks));
-
-                // Increase numberOfIf
-                std::list<ExecutionPath *>::iterator it;
-                for (it = checks.begin(); it != checks.end(); ++it)
-                {
-                    if (countif.find((*it)->varId) != countif.end())
-                        (*it)->numberOfIf++;
-                }
+                if (tok3->varId())
+                    ExecutionPath::bailOutVar(checks, tok3->varId());
             }
-        }
 
-        // for/while/switch/do .. bail out
-        if (Token::Match(tok, "for|while|switch|do"))
-        {
-            // goto {
-            const Token *tok2 = tok->next();
-            if (tok2 && tok2->str() == "(")
-                tok2 = tok2->link();
-            if (tok2 && tok2->str() == ")")
-                tok2 = tok2->next();
-            if (!tok2 || tok2->str() != "{")
+            // it is not certain that a for/while will be executed:
+            for (std::list<ExecutionPath *>::iterator it = checks.begin(); it != checks.end();)
             {
-                ExecutionPath::bailOut(checks);
-                return;
+                if ((*it)->numberOfIf > 0)
+                    checks.erase(it++);
+                else
+                    ++it;
             }
 
-            if (tok->str() != "switch")
+            // #2231 - loop body only contains a conditional initialization..
+            if (Token::simpleMatch(tok2->next(), "if ("))
             {
-                for (const Token *tok3 = tok; tok3 && tok3 != tok2; tok3 = tok3->next())
+                // Start { for the if block
+                const Token *tok3 = tok2->tokAt(2)->link();
+                if (Token::simpleMatch(tok3,") {"))
                 {
-                    if (tok3->varId())
-                        ExecutionPath::bailOutVar(checks, tok3->varId());
-                }
-
-                // it is not certain that a for/while will be executed:
-                for (std::list<ExecutionPath *>::iterator it = checks.begin(); it != checks.end();)
-                {
-                    if ((*it)->numberOfIf > 0)
-                        checks.erase(it++);
-                    else
-                        ++it;
-                }
+                    tok3 = tok3->next();
 
-                // #2231 - loop body only contains a conditional initialization..
-                if (Token::simpleMatch(tok2->next(), "if ("))
-                {
-                    // Start { for the if block
-                    const Token *tok3 = tok2->tokAt(2)->link();
-                    if (Token::simpleMatch(tok3,") {"))
+                    // End } for the if block
+                    const Token *tok4 = tok3->link();
+                    if (Token::Match(tok3, "{ %var% =") &&
+                        Token::simpleMatch(tok4, "} }") &&
+                        Token::simpleMatch(tok4->tokAt(-2), "break ;"))
                     {
-                        tok3 = tok3->next();
-
-                        // End } for the if block
-                        const Token *tok4 = tok3->link();
-                        if (Token::Match(tok3, "{ %var% =") &&
-                            Token::simpleMatch(tok4, "} }") &&
-                            Token::simpleMatch(tok4->tokAt(-2), "break ;"))
+                        // Is there a assignment and then a break?
+                        const Token *t = Token::findmatch(tok3, ";");
+                        if (t && t->tokAt(3) == tok4)
                         {
-                            // Is there a assignment and then a break?
-                            const Token *t = Token::findmatch(tok3, ";");
-                            if (t && t->tokAt(3) == tok4)
+                            for (std::list<ExecutionPath *>::iterator it = checks.begin(); it != checks.end(); ++it)
                             {
-                                for (std::list<ExecutionPath *>::iterator it = checks.begin(); it != checks.end(); ++it)
+                                if ((*it)->varId == tok3->next()->varId())
                                 {
-                                    if ((*it)->varId == tok3->next()->varId())
-                                    {
-                                        (*it)->numberOfIf++;
-                                        break;
-                                    }
+                                    (*it)->numberOfIf++;
+                                    break;
                                 }
-                                tok = tok2->link();
-                                continue;
                             }
+                            return tok2->link();
                         }
                     }
                 }
-
-                // parse loop bodies
-                check->parseLoopBody(tok2->next(), checks);
             }
 
-            // skip { .. }
-            tok2 = tok2->link();
+            // parse loop bodies
+            check.parseLoopBody(tok2->next(), checks);
+        }
 
-            // if "do { .. } while ( .." , goto end of while..
-            if (Token::simpleMatch(tok, "do {") && Token::simpleMatch(tok2, "} while ("))
-                tok2 = tok2->tokAt(2)->link();
+        // skip { .. }
+        tok2 = tok2->link();
 
-            // bail out all variables if the scope contains a "return"
-            // bail out all variables used in this for/while/switch/do
-            for (; tok && tok != tok2; tok = tok->next())
-            {
-                if (tok->str() == "return")
-                    ExecutionPath::bailOut(checks);
-                if (tok->varId())
-                    ExecutionPath::bailOutVar(checks, tok->varId());
-            }
+        // if "do { .. } while ( .." , goto end of while..
+        if (Token::simpleMatch(tok, "do {") && Token::simpleMatch(tok2, "} while ("))
+            tok2 = tok2->tokAt(2)->link();
 
-            continue;
+        // bail out all variables if the scope contains a "return"
+        // bail out all variables used in this for/while/switch/do
+        for (; tok && tok != tok2; tok = tok->next())
+        {
+            if (tok->str() == "return")
+                ExecutionPath::bailOut(checks);
+            if (tok->varId())
+                ExecutionPath::bailOutVar(checks, tok->varId());
         }
 
-        // bailout used variables in '; FOREACH ( .. ) { .. }'
-        else if (tok->str() != "if" && Token::Match(tok->previous(), "[;{}] %var% ("))
+        return tok;
+    }
+
+    // bailout used variables in '; FOREACH ( .. ) { .. }'
+    else if (tok->str() != "if" && Token::Match(tok->previous(), "[;{}] %var% ("))
+    {
+        // goto {
+        const Token *tok2 = tok->next()->link();
+        if (tok2 && tok2->str() == ")")
         {
-            // goto {
-            const Token *tok2 = tok->next()->link();
-            if (tok2 && tok2->str() == ")")
+            tok2 = tok2->next();
+            if (tok2 && tok2->str() == "{")
             {
-                tok2 = tok2->next();
-                if (tok2 && tok2->str() == "{")
-                {
-                    // goto "}"
-                    tok2 = tok2->link();
+                // goto "}"
+                tok2 = tok2->link();
 
-                    // bail out all variables used in "{ .. }"
-                    for (; tok && tok != tok2; tok = tok->next())
-                    {
-                        if (tok->varId())
-                            ExecutionPath::bailOutVar(checks, tok->varId());
-                    }
+                // bail out all variables used in "{ .. }"
+                for (; tok && tok != tok2; tok = tok->next())
+                {
+                    if (tok->varId())
+                        ExecutionPath::bailOutVar(checks, tok->varId());
                 }
             }
         }
+    }
+
+    // .. ) { ... }  => bail out
+    if (Token::simpleMatch(tok, ") {"))
+    {
+        ExecutionPath::bailOut(checks);
+        return 0;
+    }
+
+    if (Token::Match(tok, "abort|exit ("))
+    {
+        ExecutionPath::bailOut(checks);
+        return 0;
+    }
+
+    // don't parse into "struct type { .."
+    if (Token::Match(tok, "struct|union|class %type% {|:"))
+    {
+        while (tok && tok->str() != "{" && tok->str() != ";")
+            tok = tok->next();
+        tok = tok ? tok->link() : 0;
+        if (!tok)
+        {
+            ExecutionPath::bailOut(checks);
+            return 0;
+        }
+    }
 
-        // .. ) { ... }  => bail out
-        if (Token::simpleMatch(tok, ") {"))
+    if (Token::simpleMatch(tok, "= {"))
+    {
+        // GCC struct initialization.. bail out
+        if (Token::Match(tok->tokAt(2), ". %var% ="))
         {
             ExecutionPath::bailOut(checks);
-            return;
+            return 0;
         }
 
-        if (Token::Match(tok, "abort|exit ("))
+        tok = tok->next()->link();
+        if (!tok)
+            ExecutionPath::bailOut(checks);
+        return tok;
+    }
+
+    tok = check.parse(*tok, checks);
+    if (checks.empty())
+        return 0;
+
+    // return/throw ends all execution paths
+    if (tok->str() == "return" ||
+        tok->str() == "throw" ||
+        tok->str() == "continue" ||
+        tok->str() == "break")
+    {
+        ExecutionPath::bailOut(checks);
+    }
+
+    return tok;
+}
+
+
+void ExecutionPath::checkScope(const Token *tok, std::list<ExecutionPath *> &checks)
+{
+    if (!tok || tok->str() == "}" || checks.empty())
+        return;
+
+    const std::auto_ptr<ExecutionPath> check(checks.front()->copy());
+
+    for (; tok; tok = tok->next())
+    {
+        // might be a noreturn function..
+        if (Token::simpleMatch(tok->tokAt(-2), ") ; }") &&
+            Token::Match(tok->tokAt(-2)->link()->tokAt(-2), "[;{}] %var% (") &&
+            tok->tokAt(-2)->link()->previous()->varId() == 0)
         {
             ExecutionPath::bailOut(checks);
             return;
         }
 
-        // don't parse into "struct type { .."
-        if (Token::Match(tok, "struct|union|class %type% {|:"))
+        if (tok->str() == "}" || tok->str() == "break")
+            return;
+
+        if (Token::simpleMatch(tok, "while (") && checks.size() > 10)
         {
-            while (tok && tok->str() != "{" && tok->str() != ";")
-                tok = tok->next();
-            tok = tok ? tok->link() : 0;
-            if (!tok)
-            {
-                ExecutionPath::bailOut(checks);
-                return;
-            }
+            ExecutionPath::bailOut(checks);
+            return;
         }
 
-        if (Token::simpleMatch(tok, "= {"))
+        if (tok->str() == "switch")
         {
-            // GCC struct initialization.. bail out
-            if (Token::Match(tok->tokAt(2), ". %var% ="))
+            // parse condition
+            if (checks.size() > 10 || check->parseCondition(*tok->next(), checks))
             {
                 ExecutionPath::bailOut(checks);
                 return;
             }
 
-            tok = tok->next()->link();
-            if (!tok)
+            const Token *tok2 = tok->next()->link();
+            if (Token::simpleMatch(tok2, ") { case"))
             {
-                ExecutionPath::bailOut(checks);
-                return;
+                // what variable ids should the if be counted for?
+                std::set<unsigned int> countif;
+
+                std::list<ExecutionPath *> newchecks;
+
+                for (tok2 = tok2->tokAt(2); tok2; tok2 = tok2->next())
+                {
+                    if (tok2->str() == "{")
+                        tok2 = tok2->link();
+                    else if (tok2->str() == "}")
+                        break;
+                    else if (tok2->str() == "case" &&
+                             !Token::Match(tok2, "case %num% : ; case"))
+                    {
+                        parseIfSwitchBody(tok2, checks, newchecks, countif);
+                    }
+                }
+
+                // Add newchecks to checks..
+                std::copy(newchecks.begin(), newchecks.end(), std::back_inserter(checks));
+
+                // Increase numberOfIf
+                std::list<ExecutionPath *>::iterator it;
+                for (it = checks.begin(); it != checks.end(); ++it)
+                {
+                    if (countif.find((*it)->varId) != countif.end())
+                        (*it)->numberOfIf++;
+                }
             }
-            continue;
         }
 
         // ; { ... }
@@ -491,51 +518,392 @@ void ExecutionPath::checkScope(const Token *tok, std::list<ExecutionPath *> &che
             }
         }
 
+        tok = parseToken(*check, tok, checks);
+        if (!tok)
+            return;
+    }
+}
 
-        {
-            tok = check->parse(*tok, checks);
-            if (checks.empty())
-                return;
-        }
+void checkExecutionPaths(const Tokenizer *tokenizer, ExecutionPath *c)
+{
+    const std::vector<const Token *> &bodies = tokenizer->getBodies();
+    for (std::vector<const Token *>::const_iterator it = bodies.begin(); it != bodies.end(); ++it)
+    {
+        const Token * const tok = *it;
+
+        std::list<ExecutionPath *> checks;
+        checks.push_back(c->copy());
+        ExecutionPath::checkScope(tok, checks);
 
-        // return/throw ends all execution paths
-        if (tok->str() == "return" ||
-            tok->str() == "throw" ||
-            tok->str() == "continue" ||
-            tok->str() == "break")
+        c->end(checks, tok->link());
+
+        while (!checks.empty())
         {
-            ExecutionPath::bailOut(checks);
+            delete checks.back();
+            checks.pop_back();
         }
     }
 }
 
-void checkExecutionPaths(const Token *tok, ExecutionPath *c)
+
+/**
+ * @brief The basic blocks of a body. A basic block is a sequence of
+ * statements that are always executed in order. The blocks are numbered
+ * so that the predecessors of a block come before it. Loops are not
+ * divided into blocks, they are parsed by parseToken(). The bodies of
+ * for/while loops are checked as separate bodies.
+ */
+class BasicBlocks
 {
-    for (; tok; tok = tok->next())
+public:
+    /** @brief Statements that are executed in sequence */
+    class Block
     {
-        if (tok->str() != ")")
-            continue;
+    public:
+        Block() : start(0), end(0), condition(0)
+        { }
+
+        /** First token, 0 if the block has no statements */
+        const Token *start;
+
+        /** Last token */
+        const Token *end;
+
+        /** First token in the if/switch condition at the end of the block, 0 if there is none */
+        const Token *condition;
+
+        /** The blocks that can be executed before this block */
+        std::vector<unsigned int> predecessors;
+    };
+
+    /**
+     * @brief Divide a body into basic blocks
+     * @param body the "{" of the body
+     */
+    explicit BasicBlocks(const Token *body)
+    {
+        newBlock();
+        last = parseBlock(body->next(), body->link(), 0);
+    }
+
+    /** The blocks, the first block is the start of the body */
+    std::vector<Block> blocks;
+
+    /** The block that ends at the end of the body */
+    unsigned int last;
+
+private:
+    unsigned int newBlock()
+    {
+        blocks.push_back(Block());
+        return static_cast<unsigned int>(blocks.size() - 1);
+    }
+
+    unsigned int newBlock(unsigned int predecessor)
+    {
+        const unsigned int block = newBlock();
+        blocks[block].predecessors.push_back(predecessor);
+        return block;
+    }
+
+    void addStatement(unsigned int block, const Token *start, const Token *end)
+    {
+        if (!blocks[block].start)
+            blocks[block].start = start;
+        blocks[block].end = end;
+    }
+
+    /** Get the last token of a statement that doesn't branch */
+    static const Token *statementEnd(const Token *tok)
+    {
+        if (Token::Match(tok, "for|while (") && Token::simpleMatch(tok->next()->link(), ") {"))
+            return tok->next()->link()->next()->link();
 
-        // Start of implementation..
-        if (Token::Match(tok, ") const| {"))
+        if (Token::simpleMatch(tok, "do {"))
         {
-            // goto the "{"
-            tok = tok->next();
-            if (tok->str() == "const")
-                tok = tok->next();
+            const Token *end = tok->next()->link();
+            if (Token::simpleMatch(end, "} while ("))
+            {
+                end = end->tokAt(2)->link();
+                if (Token::simpleMatch(end, ") ;"))
+                    end = end->next();
+            }
+            return end;
+        }
+
+        if (Token::simpleMatch(tok, "try {"))
+        {
+            const Token *end = tok->next()->link();
+            while (Token::simpleMatch(end, "} catch (") && Token::simpleMatch(end->tokAt(2)->link(), ") {"))
+                end = end->tokAt(2)->link()->next()->link();
+            return end;
+        }
+
+        const Token *last = tok;
+        for (; tok; tok = tok->next())
+        {
+            if (tok->str() == ";")
+                return tok;
+            if (tok->str() == "}")
+                break;
+            if (Token::Match(tok, "(|[") && tok->link())
+                tok = tok->link();
+            else if (tok->str() == "{" && tok->link())
+            {
+                // "FOREACH ( .. ) { .. }"
+                if (tok->previous()->str() == ")")
+                    return tok->link();
+                tok = tok->link();
+            }
+            last = tok;
+        }
+        return last;
+    }
+
+    /**
+     * Parse the statements in a block
+     * @param tok first token in the block
+     * @param end the "}" of the block
+     * @param cur the current basic block
+     * @return the basic block where the execution continues after the block
+     */
+    unsigned int parseBlock(const Token *tok, const Token *end, unsigned int cur)
+    {
+        while (tok && tok != end)
+            tok = parseStatement(tok, cur)->next();
+
+        // might be a noreturn function..
+        if (Token::simpleMatch(end->tokAt(-2), ") ; }") &&
+            Token::Match(end->tokAt(-2)->link()->tokAt(-2), "[;{}] %var% (") &&
+            end->tokAt(-2)->link()->previous()->varId() == 0)
+        {
+            return newBlock();
+        }
+
+        return cur;
+    }
+
+    /**
+     * Parse a statement
+     * @param tok first token in the statement
+     * @param cur the current basic block, updated to the block where the execution continues
+     * @return the last token in the statement
+     */
+    const Token *parseStatement(const Token *tok, unsigned int &cur)
+    {
+        if (tok->str() == "{" && tok->link())
+        {
+            cur = parseBlock(tok->next(), tok->link(), cur);
+            return tok->link();
+        }
+
+        // label
+        if (Token::Match(tok, "%var% :") && !Token::Match(tok, "case|default|public|protected|private"))
+        {
+            addStatement(cur, tok, tok->next());
+            return tok->next();
+        }
+
+        if (!Token::Match(tok, "if|switch (") || !tok->next()->link())
+        {
+            const Token * const last = statementEnd(tok);
+            addStatement(cur, tok, last);
+            return last;
+        }
+
+        blocks[cur].condition = tok->tokAt(2);
+        const unsigned int condition = cur;
+
+        // if/switch without { .. } => the execution paths end
+        const Token * const body = tok->next()->link()->next();
+        if (!Token::simpleMatch(body, "{") || !body->link())
+        {
+            cur = newBlock();
+            return statementEnd(tok);
+        }
+
+        if (tok->str() == "if")
+        {
+            const unsigned int then = parseBlock(body->next(), body->link(), newBlock(condition));
+
+            unsigned int els = condition;
+            const Token *last = body->link();
+            if (Token::simpleMatch(last, "} else"))
+            {
+                els = newBlock(condition);
+                last = parseStatement(last->tokAt(2), els);
+            }
+
+            cur = newBlock(then);
+            blocks[cur].predecessors.push_back(els);
+            return last;
+        }
+
+        // switch: the code before the first case can't be reached
+        unsigned int block = newBlock();
+        for (const Token *tok2 = body->next(); tok2 && tok2 != body->link(); tok2 = tok2->next())
+        {
+            if (Token::Match(tok2, "case|default"))
+            {
+                while (tok2->next() != body->link() && tok2->str() != ":")
+                    tok2 = tok2->next();
+
+                // jump to the case or fall through from the previous case
+                const unsigned int caseBlock = newBlock(condition);
+                blocks[caseBlock].predecessors.push_back(block);
+                block = caseBlock;
+            }
+            else
+            {
+                tok2 = parseStatement(tok2, block);
+            }
+        }
+
+        // The code after the switch. The variables that are used in
+        // the switch are bailed out by parseToken().
+        cur = newBlock(condition);
+        addStatement(cur, tok, body->link());
+        return body->link();
+    }
+};
+
+
+/** Execution paths sorted by variable id */
+typedef std::multimap<unsigned int, const ExecutionPath *> ExecutionPathIndex;
+
+/** Is there an execution path that is equal to the given path in the index? */
+static bool contains(const ExecutionPathIndex &index, const ExecutionPath &path)
+{
+    const std::pair<ExecutionPathIndex::const_iterator, ExecutionPathIndex::const_iterator> range = index.equal_range(path.varId);
+    for (ExecutionPathIndex::const_iterator it = range.first; it != range.second; ++it)
+    {
+        if (*it->second == path && it->second->numberOfIf == path.numberOfIf)
+            return true;
+    }
+    return false;
+}
 
-            std::list<ExecutionPath *> checks;
-            checks.push_back(c->copy());
-            ExecutionPath::checkScope(tok, checks);
+/**
+ * @brief Merge the execution paths of the blocks that lead to a block. The
+ * numberOfIf of a variable is increased if its paths are different in the
+ * blocks, as it is when checkScope() merges the paths of an if.
+ * @param predecessors the blocks that lead to the block
+ * @param paths the execution paths at the end of each block
+ * @param checks the merged execution paths
+ */
+static void mergePaths(const std::vector<unsigned int> &predecessors,
+                       std::vector<std::list<ExecutionPath *> > &paths,
+                       std::list<ExecutionPath *> &checks)
+{
+    // the blocks where the execution continues
+    std::vector<const std::list<ExecutionPath *> *> branches;
+    for (std::vector<unsigned int>::const_iterator it = predecessors.begin(); it != predecessors.end(); ++it)
+    {
+        if (!paths[*it].empty())
+            branches.push_back(&paths[*it]);
+    }
+    if (branches.empty())
+        return;
+
+    std::vector<ExecutionPathIndex> index(branches.size());
+    for (unsigned int i = 0; i < branches.size(); ++i)
+    {
+        for (std::list<ExecutionPath *>::const_iterator it = branches[i]->begin(); it != branches[i]->end(); ++it)
+            index[i].insert(std::make_pair((*it)->varId, *it));
+    }
 
-            c->end(checks, tok->link());
+    // what variable ids should the numberOfIf be counted for?
+    std::set<unsigned int> countif;
+    for (unsigned int i = 1; i < branches.size(); ++i)
+    {
+        std::list<ExecutionPath *>::const_iterator it;
+        for (it = branches[i]->begin(); it != branches[i]->end(); ++it)
+        {
+            if (!contains(index[0], **it))
+                countif.insert((*it)->varId);
+        }
+        for (it = branches[0]->begin(); it != branches[0]->end(); ++it)
+        {
+            if (!contains(index[i], **it))
+                countif.insert((*it)->varId);
+        }
+    }
 
-            while (!checks.empty())
+    ExecutionPathIndex merged;
+    for (unsigned int i = 0; i < branches.size(); ++i)
+    {
+        for (std::list<ExecutionPath *>::const_iterator it = branches[i]->begin(); it != branches[i]->end(); ++it)
+        {
+            if (!contains(merged, **it))
             {
-                delete checks.back();
-                checks.pop_back();
+                checks.push_back((*it)->copy());
+                merged.insert(std::make_pair(checks.back()->varId, checks.back()));
             }
         }
     }
+
+    // Increase numberOfIf, delete checks that have numberOfIf >= 2
+    for (std::list<ExecutionPath *>::iterator it = checks.begin(); it != checks.end();)
+    {
+        if ((*it)->varId > 0 && countif.find((*it)->varId) != countif.end() && ++(*it)->numberOfIf >= 2)
+        {
+            delete *it;
+            checks.erase(it++);
+        }
+        else
+        {
+            ++it;
+        }
+    }
+}
+
+/**
+ * @brief Parse the statements and the condition of a basic block
+ * @param check the check
+ * @param block the block
+ * @param checks the execution paths at the start of the block. They are
+ * updated to the paths at the end of the block, empty => the execution ends.
+ */
+static void parseBasicBlock(ExecutionPath &check, const BasicBlocks::Block &block, std::list<ExecutionPath *> &checks)
+{
+    for (const Token *tok = block.start; tok; tok = tok->next())
+    {
+        tok = parseToken(check, tok, checks);
+        if (!tok)
+        {
+            ExecutionPath::bailOut(checks);
+            return;
+        }
+        if (checks.empty() || tok == block.end)
+            break;
+    }
+
+    if (!checks.empty() && block.condition && check.parseCondition(*block.condition, checks))
+        ExecutionPath::bailOut(checks);
 }
 
+void checkExecutionPathsDataflow(const Tokenizer *tokenizer, ExecutionPath *c)
+{
+    const std::vector<const Token *> &bodies = tokenizer->getBodies();
+    for (std::vector<const Token *>::const_iterator it = bodies.begin(); it != bodies.end(); ++it)
+    {
+        const BasicBlocks body(*it);
+
+        // the execution paths at the end of each block
+        std::vector<std::list<ExecutionPath *> > paths(body.blocks.size());
+
+        paths[0].push_back(c->copy());
+        for (unsigned int i = 0; i < body.blocks.size(); ++i)
+        {
+            if (i > 0)
+                mergePaths(body.blocks[i].predecessors, paths, paths[i]);
+            if (!paths[i].empty())
+                parseBasicBlock(*c, body.blocks[i], paths[i]);
+        }
+
+        c->end(paths[body.last], (*it)->link());
+
+        for (unsigned int i = 0; i < paths.size(); ++i)
+            ExecutionPath::bailOut(paths[i]);
+    }
+}
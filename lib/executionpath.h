@@ -23,6 +23,7 @@
 
 class Token;
 class Check;
+class Tokenizer;
 
 /**
  * Base class for Execution Paths checking
@@ -136,8 +137,21 @@ public:
 };
 
 
-void checkExecutionPaths(const Token *tok, ExecutionPath *c);
-void checkExecutionPaths(const Token *tok, ExecutionPath *c);
+/**
+ * @brief Check the execution paths of every body in the code
+ * @param tokenizer the tokenizer. The bodies are taken from Tokenizer::getBodies().
+ * @param c the check
+ */
+void checkExecutionPaths(const Tokenizer *tokenizer, ExecutionPath *c);
+
+/**
+ * @brief Check the execution paths of every body in the code with dataflow
+ * over basic blocks. The paths are merged where the branches join, so there
+ * is no limit for the number of paths.
+ * @param tokenizer the tokenizer. The bodies are taken from Tokenizer::getBodies().
+ * @param c the check
+ */
+void checkExecutionPathsDataflow(const Tokenizer *tokenizer, ExecutionPath *c);
 
 
 #endif
@@ -0,0 +1,46 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef hashH
+#define hashH
+
+#include <string>
+
+/// @addtogroup Core
+/// @{
+
+/**
+ * @brief Calculate a 64-bit FNV-1a hash of data.
+ * @param data the data
+ * @param hash hash of previous data, to calculate one hash for several strings
+ * @return the hash
+ */
+inline unsigned long long fnv1aHash(const std::string &data, unsigned long long hash = 14695981039346656037ULL)
+{
+    for (std::string::size_type i = 0; i < data.length(); ++i)
+    {
+        hash ^= static_cast<unsigned char>(data[i]);
+        hash *= 1099511628211ULL;
+    }
+    return hash;
+}
+
+/// @}
+
+#endif
@@ -1,6 +1,7 @@
 # no manual edits - this file is autogenerated by dmake
 
 LIBS += -L../externals -lpcre
+unix:LIBS += -lpthread
 INCLUDEPATH += ../externals ../externals/tinyxml
 HEADERS += $${BASEPATH}check.h \
            $${BASEPATH}checkautovariables.h \
@@ -18,11 +19,15 @@ HEADERS += $${BASEPATH}check.h \
            $${BASEPATH}cppcheck.h \
            $${BASEPATH}errorlogger.h \
            $${BASEPATH}executionpath.h \
+           $${BASEPATH}mappedfile.h \
            $${BASEPATH}mathlib.h \
            $${BASEPATH}path.h \
            $${BASEPATH}preprocessor.h \
+           $${BASEPATH}progress.h \
+           $${BASEPATH}resultcache.h \
            $${BASEPATH}settings.h \
            $${BASEPATH}symboldatabase.h \
+           $${BASEPATH}threading.h \
            $${BASEPATH}timer.h \
            $${BASEPATH}token.h \
            $${BASEPATH}tokenize.h
@@ -42,11 +47,15 @@ SOURCES += $${BASEPATH}checkautovariables.cpp \
            $${BASEPATH}cppcheck.cpp \
            $${BASEPATH}errorlogger.cpp \
            $${BASEPATH}executionpath.cpp \
+           $${BASEPATH}mappedfile.cpp \
            $${BASEPATH}mathlib.cpp \
            $${BASEPATH}path.cpp \
            $${BASEPATH}preprocessor.cpp \
+           $${BASEPATH}progress.cpp \
+           $${BASEPATH}resultcache.cpp \
            $${BASEPATH}settings.cpp \
            $${BASEPATH}symboldatabase.cpp \
+           $${BASEPATH}threading.cpp \
            $${BASEPATH}timer.cpp \
            $${BASEPATH}token.cpp \
            $${BASEPATH}tokenize.cpp
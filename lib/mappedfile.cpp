@@ -0,0 +1,119 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "mappedfile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+#include <fstream>
+#include <iterator>
+
+MappedFile::MappedFile() : _data(0), _size(0), _open(false), _mapping(0)
+{
+}
+
+MappedFile::~MappedFile()
+{
+    close();
+}
+
+bool MappedFile::open(const std::string &filename)
+{
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(filename.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (file != INVALID_HANDLE_VALUE)
+    {
+        LARGE_INTEGER size;
+        if (GetFileSizeEx(file, &size) && size.QuadPart > 0 && size.QuadPart == (std::size_t)size.QuadPart)
+        {
+            HANDLE mapping = CreateFileMappingA(file, NULL, PAGE_READONLY, 0, 0, NULL);
+            if (mapping)
+            {
+                const void *view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+                if (view)
+                {
+                    _data = static_cast<const char *>(view);
+                    _size = (std::size_t)size.QuadPart;
+                    _mapping = mapping;
+                }
+                else
+                    CloseHandle(mapping);
+            }
+        }
+        CloseHandle(file);
+    }
+#else
+    const int fd = ::open(filename.c_str(), O_RDONLY);
+    if (fd >= 0)
+    {
+        struct stat st;
+        if (fstat(fd, &st) == 0 && S_ISREG(st.st_mode) && st.st_size > 0)
+        {
+            void *view = mmap(NULL, (std::size_t)st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (view != MAP_FAILED)
+            {
+                _data = static_cast<const char *>(view);
+                _size = (std::size_t)st.st_size;
+                _mapping = view;
+            }
+        }
+        ::close(fd);
+    }
+#endif
+
+    if (!_mapping)
+    {
+        // Empty files and files that can't be mapped are read
+        std::ifstream fin(filename.c_str(), std::ios::in | std::ios::binary);
+        if (!fin.is_open())
+            return false;
+        _buffer.assign(std::istreambuf_iterator<char>(fin), std::istreambuf_iterator<char>());
+        _data = _buffer.data();
+        _size = _buffer.size();
+    }
+
+    _open = true;
+    return true;
+}
+
+void MappedFile::close()
+{
+    if (_mapping)
+    {
+#ifdef _WIN32
+        UnmapViewOfFile(_data);
+        CloseHandle(static_cast<HANDLE>(_mapping));
+#else
+        munmap(_mapping, _size);
+#endif
+    }
+    _mapping = 0;
+    _data = 0;
+    _size = 0;
+    _open = false;
+    _buffer.clear();
+}
@@ -0,0 +1,83 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef mappedfileH
+#define mappedfileH
+
+#include <cstddef>
+#include <string>
+
+/// @addtogroup Core
+/// @{
+
+/**
+ * @brief The contents of a file. The file is mapped into memory when
+ * possible so the preprocessor can read it without copying it. If it
+ * can't be mapped it is read into a buffer.
+ */
+class MappedFile
+{
+public:
+    MappedFile();
+    ~MappedFile();
+
+    /**
+     * Open a file. A file that is already open is closed first.
+     * @param filename name of the file
+     * @return true if the file was opened
+     */
+    bool open(const std::string &filename);
+
+    /** Close the file */
+    void close();
+
+    bool isOpen() const
+    {
+        return _open;
+    }
+
+    /** The contents of the file. It is not null terminated. */
+    const char *data() const
+    {
+        return _data;
+    }
+
+    std::size_t size() const
+    {
+        return _size;
+    }
+
+private:
+    const char *_data;
+    std::size_t _size;
+    bool _open;
+
+    /** @brief platform specific mapping, NULL if the file was read into _buffer */
+    void *_mapping;
+
+    /** @brief contents of a file that could not be mapped */
+    std::string _buffer;
+
+    // Not implemented..
+    MappedFile(const MappedFile &);
+    void operator=(const MappedFile &);
+};
+
+/// @}
+
+#endif // mappedfileH
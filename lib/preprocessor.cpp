@@ -23,17 +23,25 @@
 #include "path.h"
 #include "errorlogger.h"
 #include "settings.h"
+#include "progress.h"
+#include "mappedfile.h"
+#include "threading.h"
 
 #include <algorithm>
 #include <stdexcept>
 #include <sstream>
-#include <fstream>
+#include <iterator>
 #include <cstdlib>
 #include <cctype>
 #include <cstring>
 #include <vector>
 #include <set>
 #include <stack>
+#include <map>
+#include <fstream>
+#include <ctime>
+#include <sys/types.h>
+#include <sys/stat.h>
 
 Preprocessor::Preprocessor(Settings *settings, ErrorLogger *errorLogger) : _settings(settings), _errorLogger(errorLogger)
 {
@@ -56,21 +64,47 @@ void Preprocessor::writeError(const std::string &fileName, const unsigned int li
                            errorType));
 }
 
-static unsigned char readChar(std::istream &istr)
+/**
+ * Get the next character of the code. "\r\n" and "\r" are read as "\n".
+ * @param data the code
+ * @param size size of the code
+ * @param pos position of the character, it is moved past it
+ */
+static unsigned char readChar(const char data[], std::size_t size, std::size_t &pos)
 {
-    unsigned char ch = (unsigned char)istr.get();
+    unsigned char ch = (unsigned char)data[pos++];
 
     // Handling of newlines..
     if (ch == '\r')
     {
         ch = '\n';
-        if ((char)istr.peek() == '\n')
-            (void)istr.get();
+        if (pos < size && data[pos] == '\n')
+            ++pos;
     }
 
     return ch;
 }
 
+/**
+ * Get the next line of a string, the same way as std::getline
+ * @param str the string
+ * @param pos start of the line, it is moved to the start of the next line
+ * @param line the line is copied here without the newline
+ * @return false if there are no more lines
+ */
+static bool nextLine(const std::string &str, std::string::size_type &pos, std::string &line)
+{
+    if (pos >= str.size())
+        return false;
+
+    std::string::size_type end = str.find('\n', pos);
+    if (end == std::string::npos)
+        end = str.size();
+    line.assign(str, pos, end - pos);
+    pos = (end < str.size()) ? end + 1 : end;
+    return true;
+}
+
 // Splits a string that contains the specified separator into substrings
 static std::list<std::string> split(const std::string &s, char separator)
 {
@@ -108,16 +142,25 @@ static std::string join(const std::list<std::string> &list, char separator)
 
 /** Just read the code into a string. Perform simple cleanup of the code */
 std::string Preprocessor::read(std::istream &istr, const std::string &filename, Settings *settings)
+{
+    const std::string data((std::istreambuf_iterator<char>(istr)), std::istreambuf_iterator<char>());
+    return read(data.data(), data.size(), filename, settings);
+}
+
+std::string Preprocessor::read(const char data[], std::size_t size, const std::string &filename, Settings *settings)
 {
     // ------------------------------------------------------------------------------------------
     //
     // handling <backspace><newline>
     // when this is encountered the <backspace><newline> will be "skipped".
     // on the next <newline>, extra newlines will be added
-    std::ostringstream code;
+    std::string result;
+    result.reserve(size);
     unsigned int newlines = 0;
-    for (unsigned char ch = readChar(istr); istr.good(); ch = readChar(istr))
+    for (std::size_t pos = 0; pos < size;)
     {
+        unsigned char ch = readChar(data, size, pos);
+
         // Replace assorted special chars with spaces..
         if (((ch & 0x80) == 0) && (ch != '\n') && (std::isspace(ch) || std::iscntrl(ch)))
             ch = ' ';
@@ -129,18 +172,19 @@ std::string Preprocessor::read(std::istream &istr, const std::string &filename,
         // The solution for now is to have a compiler-dependent behaviour.
         if (ch == '\\')
         {
-            unsigned char chNext;
+            unsigned char chNext = 0;
 
 #ifdef __GNUC__
             // gcc-compatibility: ignore spaces
-            for (;;)
+            while (pos < size)
             {
-                chNext = (unsigned char)istr.peek();
+                chNext = (unsigned char)data[pos];
                 if (chNext != '\n' && chNext != '\r' &&
                     (std::isspace(chNext) || std::iscntrl(chNext)))
                 {
                     // Skip whitespace between <backspace> and <newline>
-                    (void)readChar(istr);
+                    (void)readChar(data, size, pos);
+                    chNext = 0;
                     continue;
                 }
 
@@ -148,30 +192,29 @@ std::string Preprocessor::read(std::istream &istr, const std::string &filename,
             }
 #else
             // keep spaces
-            chNext = (unsigned char)istr.peek();
+            if (pos < size)
+                chNext = (unsigned char)data[pos];
 #endif
             if (chNext == '\n' || chNext == '\r')
             {
                 ++newlines;
-                (void)readChar(istr);   // Skip the "<backspace><newline>"
+                (void)readChar(data, size, pos);   // Skip the "<backspace><newline>"
             }
             else
-                code << "\\";
+                result += '\\';
         }
         else
         {
-            code << char(ch);
+            result += char(ch);
 
             // if there has been <backspace><newline> sequences, add extra newlines..
             if (ch == '\n' && newlines > 0)
             {
-                code << std::string(newlines, '\n');
+                result.append(newlines, '\n');
                 newlines = 0;
             }
         }
     }
-    std::string result = code.str();
-    code.str("");
 
     // ------------------------------------------------------------------------------------------
     //
@@ -197,11 +240,12 @@ std::string Preprocessor::read(std::istream &istr, const std::string &filename,
 
 std::string Preprocessor::preprocessCleanupDirectives(const std::string &processedFile) const
 {
-    std::ostringstream code;
-    std::istringstream sstr(processedFile);
+    std::string code;
+    code.reserve(processedFile.size());
 
     std::string line;
-    while (std::getline(sstr, line))
+    std::string::size_type pos = 0;
+    while (nextLine(processedFile, pos, line))
     {
         // Trim lines..
         if (!line.empty() && line[0] == ' ')
@@ -220,7 +264,7 @@ std::string Preprocessor::preprocessCleanupDirectives(const std::string &process
             } escapeStatus = ESC_NONE;
 
             char prev = ' '; // hack to make it skip spaces between # and the directive
-            code << "#";
+            code += '#';
             std::string::const_iterator i = line.begin();
             ++i;
 
@@ -260,14 +304,14 @@ std::string Preprocessor::preprocessCleanupDirectives(const std::string &process
                     if (needSpace)
                     {
                         if (*i == '(' || *i == '!')
-                            code << " ";
+                            code += ' ';
                         else if (!std::isalpha(*i))
                             needSpace = false;
                     }
                     if (*i == '#')
                         needSpace = true;
                 }
-                code << *i;
+                code += *i;
                 if (escapeStatus != ESC_NONE && prev == '\\' && *i == '\\')
                 {
                     prev = ' ';
@@ -286,12 +330,13 @@ std::string Preprocessor::preprocessCleanupDirectives(const std::string &process
         else
         {
             // Do not mess with regular code..
-            code << line;
+            code += line;
         }
-        code << (sstr.eof()?"":"\n");
+        if (processedFile[pos - 1] == '\n')
+            code += '\n';
     }
 
-    return code.str();
+    return code;
 }
 
 static bool hasbom(const std::string &str)
@@ -333,7 +378,8 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
     // when this is encountered the <backspace><newline> will be "skipped".
     // on the next <newline>, extra newlines will be added
     unsigned int newlines = 0;
-    std::ostringstream code;
+    std::string code;
+    code.reserve(str.size());
     unsigned char previous = 0;
     bool inPreprocessorLine = false;
     std::vector<std::string> suppressionIDs;
@@ -355,7 +401,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
             str.compare(i, 8, "#warning") == 0)
         {
             if (str.compare(i, 6, "#error") == 0)
-                code << "#error";
+                code += "#error";
 
             i = str.find("\n", i);
             if (i == std::string::npos)
@@ -374,7 +420,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
             }
             else
             {
-                code << char(ch);
+                code += char(ch);
                 previous = ch;
             }
 
@@ -386,7 +432,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
                 ++lineno;
                 if (newlines > 0)
                 {
-                    code << std::string(newlines, '\n');
+                    code.append(newlines, '\n');
                     newlines = 0;
                     previous = '\n';
                 }
@@ -422,7 +468,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
                 fallThroughComment = true;
             }
 
-            code << "\n";
+            code += '\n';
             previous = '\n';
             ++lineno;
         }
@@ -464,7 +510,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
         }
         else if (ch == '#' && previous == '\n')
         {
-            code << ch;
+            code += char(ch);
             previous = ch;
             inPreprocessorLine = true;
         }
@@ -508,7 +554,7 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
             // String or char constants..
             if (ch == '\"' || ch == '\'')
             {
-                code << char(ch);
+                code += char(ch);
                 char chNext;
                 do
                 {
@@ -522,14 +568,14 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
                             ++newlines;
                         else
                         {
-                            code << chNext;
-                            code << chSeq;
+                            code += chNext;
+                            code += chSeq;
                             previous = static_cast<unsigned char>(chSeq);
                         }
                     }
                     else
                     {
-                        code << chNext;
+                        code += chNext;
                         previous = static_cast<unsigned char>(chNext);
                     }
                 }
@@ -560,72 +606,78 @@ std::string Preprocessor::removeComments(const std::string &str, const std::stri
                 if (delim != " " && endpos != std::string::npos)
                 {
                     unsigned int rawstringnewlines = 0;
-                    code << '\"';
+                    code += '\"';
                     for (std::string::size_type p = i + 3 + delim.size(); p < endpos; ++p)
                     {
                         if (str[p] == '\n')
                         {
                             rawstringnewlines++;
-                            code << "\\n";
+                            code += "\\n";
                         }
                         else if (std::iscntrl((unsigned char)str[p]) ||
                                  std::isspace((unsigned char)str[p]))
                         {
-                            code << " ";
+                            code += ' ';
                         }
                         else if (str[p] == '\\')
                         {
-                            code << "\\";
+                            code += '\\';
                         }
                         else if (str[p] == '\"' || str[p] == '\'')
                         {
-                            code << "\\" << (char)str[p];
+                            code += '\\';
+                            code += str[p];
                         }
                         else
                         {
-                            code << (char)str[p];
+                            code += str[p];
                         }
                     }
-                    code << "\"";
+                    code += '\"';
                     if (rawstringnewlines > 0)
-                        code << std::string(rawstringnewlines, '\n');
+                        code.append(rawstringnewlines, '\n');
                     i = endpos + delim.size() + 2;
                 }
                 else
                 {
-                    code << "R";
+                    code += 'R';
                     previous = 'R';
                 }
             }
             else
             {
-                code << char(ch);
+                code += char(ch);
                 previous = ch;
             }
         }
     }
 
-    return code.str();
+    return code;
 }
 
 std::string Preprocessor::removeIf0(const std::string &code)
 {
-    std::ostringstream ret;
-    std::istringstream istr(code);
+    std::string ret;
+    ret.reserve(code.size());
+    std::string::size_type pos = 0;
     std::string line;
-    while (std::getline(istr,line))
+    while (nextLine(code, pos, line))
     {
         if (line != "#if 0")
-            ret << line << "\n";
+        {
+            ret += line;
+            ret += '\n';
+        }
         else
         {
             // replace '#if 0' with empty line
-            ret << line << "\n";
+            ret += line;
+            ret += '\n';
 
             // goto the end of the '#if 0' block
             unsigned int level = 1;
             bool in = false;
-            while (level > 0 && std::getline(istr,line))
+            while (level > 0 && nextLine(code, pos, line))
             {
                 if (line.compare(0,3,"#if") == 0)
                     ++level;
@@ -639,18 +691,18 @@ std::string Preprocessor::removeIf0(const std::string &code)
                 else
                 {
                     if (in)
-                        ret << line << "\n";
-                    else
-                        // replace code within '#if 0' block with empty lines
-                        ret << "\n";
+                        ret += line;
+                    // replace code within '#if 0' block with empty lines
+                    ret += '\n';
                     continue;
                 }
 
-                ret << line << "\n";
+                ret += line;
+                ret += '\n';
             }
         }
     }
-    return ret.str();
+    return ret;
 }
 
 
@@ -659,10 +711,11 @@ std::string Preprocessor::removeParantheses(const std::string &str)
     if (str.find("\n#if") == std::string::npos && str.compare(0, 3, "#if") != 0)
         return str;
 
-    std::istringstream istr(str.c_str());
-    std::ostringstream ret;
+    std::string ret;
+    ret.reserve(str.size());
+    std::string::size_type pos0 = 0;
     std::string line;
-    while (std::getline(istr, line))
+    while (nextLine(str, pos0, line))
     {
         if (line.compare(0, 3, "#if") == 0 || line.compare(0, 5, "#elif") == 0)
         {
@@ -723,10 +776,11 @@ std::string Preprocessor::removeParantheses(const std::string &str)
             else if (line.compare(0, 6, "#elif(") == 0)
                 line.insert(5, " ");
         }
-        ret << line << "\n";
+        ret += line;
+        ret += '\n';
     }
 
-    return ret.str();
+    return ret;
 }
 
 
@@ -888,21 +942,28 @@ void Preprocessor::preprocessWhitespaces(std::string &processedFile)
 }
 
 void Preprocessor::preprocess(std::istream &srcCodeStream, std::string &processedFile, std::list<std::string> &resultConfigurations, const std::string &filename, const std::list<std::string> &includePaths)
+{
+    const std::string data((std::istreambuf_iterator<char>(srcCodeStream)), std::istreambuf_iterator<char>());
+    preprocess(data.data(), data.size(), processedFile, resultConfigurations, filename, includePaths);
+}
+
+void Preprocessor::preprocess(const char data[], std::size_t size, std::string &processedFile, std::list<std::string> &resultConfigurations, const std::string &filename, const std::list<std::string> &includePaths)
 {
     if (file0.empty())
         file0 = filename;
 
-    processedFile = read(srcCodeStream, filename, _settings);
+    processedFile = read(data, size, filename, _settings);
 
     // Remove asm(...)
     removeAsm(processedFile);
 
     // Replace "defined A" with "defined(A)"
     {
-        std::istringstream istr(processedFile.c_str());
-        std::ostringstream ostr;
+        std::string ostr;
+        ostr.reserve(processedFile.size());
+        std::string::size_type linePos = 0;
         std::string line;
-        while (std::getline(istr, line))
+        while (nextLine(processedFile, linePos, line))
         {
             if (line.compare(0, 4, "#if ") == 0 || line.compare(0, 6, "#elif ") == 0)
             {
@@ -917,9 +978,10 @@ void Preprocessor::preprocess(std::istream &srcCodeStream, std::string &processe
                         line.insert(pos, ")");
                 }
             }
-            ostr << line << "\n";
+            ostr += line;
+            ostr += '\n';
         }
-        processedFile = ostr.str();
+        processedFile.swap(ostr);
     }
 
     handleIncludes(processedFile, filename, includePaths);
@@ -992,11 +1054,19 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
     std::list<std::string> ret;
     ret.push_back("");
 
+    // the configurations in ret, to check quickly if a configuration is already added
+    std::set<std::string> retset;
+    retset.insert("");
+
     std::list<std::string> deflist, ndeflist;
 
-    // constants defined through "#define" in the code..
+    // names of constants defined through "#define" in the code..
     std::set<std::string> defines;
 
+    // constants with values, "#define A 1" => varmap["A"] = "1".
+    // If a constant is defined several times the largest value is used.
+    std::map<std::string, std::string> varmap;
+
     // How deep into included files are we currently parsing?
     // 0=>Source file, 1=>Included by source file, 2=>included by header that was included by source file, etc
     int filelevel = 0;
@@ -1004,18 +1074,33 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
     bool includeguard = false;
 
     unsigned int linenr = 0;
-    std::istringstream istr(filedata);
+    std::string::size_type pos = 0;
+    Progress progress1(filename, "Preprocessing (get configurations 1)");
     std::string line;
-    while (getline(istr, line))
+    while (pos < filedata.size())
     {
         ++linenr;
 
-        if (_errorLogger)
-            _errorLogger->reportProgress(filename, "Preprocessing (get configurations 1)", 0);
+        progress1.value(static_cast<unsigned int>((100.0 * pos) / filedata.size()));
 
-        if (line.empty())
+        // Only the preprocessor directives are copied and parsed
+        const std::string::size_type start = pos;
+        std::string::size_type end = filedata.find('\n', pos);
+        if (end == std::string::npos)
+            end = filedata.size();
+        pos = end + 1;
+
+        if (end == start)
             continue;
 
+        if (filedata[start] != '#')
+        {
+            includeguard = false;
+            continue;
+        }
+
+        line.assign(filedata, start, end - start);
+
         if (line.compare(0, 6, "#file ") == 0)
         {
             includeguard = true;
@@ -1048,9 +1133,15 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
                 defines.insert(line.substr(8));
             else
             {
-                std::string s = line.substr(8);
-                s[s.find(" ")] = '=';
-                defines.insert(s);
+                const std::string::size_type space = line.find(" ", 8);
+                const std::string varname(line.substr(8, space - 8));
+                const std::string value(line.substr(space + 1));
+                defines.insert(varname);
+                const std::map<std::string, std::string>::iterator var = varmap.find(varname);
+                if (var == varmap.end())
+                    varmap[varname] = value;
+                else if (var->second < value)
+                    var->second = value;
             }
         }
 
@@ -1107,20 +1198,7 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
             }
 
             // Replace defined constants
-            {
-                std::map<std::string, std::string> varmap;
-                for (std::set<std::string>::const_iterator it = defines.begin(); it != defines.end(); ++it)
-                {
-                    std::string::size_type pos = it->find("=");
-                    if (pos == std::string::npos)
-                        continue;
-                    const std::string varname(it->substr(0, pos));
-                    const std::string value(it->substr(pos + 1));
-                    varmap[varname] = value;
-                }
-
-                simplifyCondition(varmap, def, false);
-            }
+            simplifyCondition(varmap, def, false);
 
             if (! deflist.empty() && line.compare(0, 6, "#elif ") == 0)
                 deflist.pop_back();
@@ -1169,7 +1247,7 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
                 deflist.push_back(nmark);
             }
 
-            if (std::find(ret.begin(), ret.end(), def) == ret.end())
+            if (retset.insert(def).second)
             {
                 ret.push_back(def);
             }
@@ -1201,49 +1279,21 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
 
     // Remove defined constants from ifdef configurations..
     unsigned int count = 0;
+    Progress progress2(filename, "Preprocessing (get configurations 2)");
     for (std::list<std::string>::iterator it = ret.begin(); it != ret.end(); ++it)
     {
-        if (_errorLogger)
-            _errorLogger->reportProgress(filename, "Preprocessing (get configurations 2)", (100 * count++) / ret.size());
+        progress2.value(static_cast<unsigned int>((100 * count++) / ret.size()));
 
-        std::string cfg(*it);
-        for (std::set<std::string>::const_iterator it2 = defines.begin(); it2 != defines.end(); ++it2)
-        {
-            std::string::size_type pos = 0;
-
-            // Get name of define
-            std::string defineName(*it2);
-            if (defineName.find("=") != std::string::npos)
-                defineName.erase(defineName.find("="));
-
-            // Remove ifdef configurations that match the defineName
-            while ((pos = cfg.find(defineName, pos)) != std::string::npos)
-            {
-                std::string::size_type pos1 = pos;
-                ++pos;
-                if (pos1 > 0 && cfg[pos1-1] != ';')
-                    continue;
-                std::string::size_type pos2 = pos1 + defineName.length();
-                if (pos2 < cfg.length() && cfg[pos2] != ';')
-                    continue;
-                --pos;
-                cfg.erase(pos, defineName.length());
-            }
-        }
-        if (cfg.length() != it->length())
+        // Remove ifdef configurations that match a define
+        const std::list<std::string> parts(split(*it, ';'));
+        std::list<std::string> cfg;
+        for (std::list<std::string>::const_iterator part = parts.begin(); part != parts.end(); ++part)
         {
-            while (cfg.length() > 0 && cfg[0] == ';')
-                cfg.erase(0, 1);
-
-            while (cfg.length() > 0 && cfg[cfg.length()-1] == ';')
-                cfg.erase(cfg.length() - 1);
-
-            std::string::size_type pos = 0;
-            while ((pos = cfg.find(";;", pos)) != std::string::npos)
-                cfg.erase(pos, 1);
-
-            *it = cfg;
+            if (defines.find(*part) == defines.end())
+                cfg.push_back(*part);
         }
+        if (cfg.size() != parts.size())
+            *it = join(cfg, ';');
     }
 
     // convert configurations: "defined(A) && defined(B)" => "A;B"
@@ -1386,16 +1436,28 @@ std::list<std::string> Preprocessor::getcfgs(const std::string &filedata, const
 }
 
 
-void Preprocessor::simplifyCondition(const std::map<std::string, std::string> &variables, std::string &condition, bool match)
+/** @brief look up a variable and remember that it was looked up */
+static std::map<std::string, std::string>::const_iterator findVariable(const std::map<std::string, std::string> &variables, const std::string &name, std::set<std::string> &lookups)
+{
+    lookups.insert(name);
+    return variables.find(name);
+}
+
+/**
+ * @brief Simplify a condition, see Preprocessor::simplifyCondition
+ * @param lookups the names of the variables that are looked up
+ * @return false if the condition could not be tokenized
+ */
+static bool simplifyConditionUncached(const std::map<std::string, std::string> &variables, std::string &condition, bool match, std::set<std::string> &lookups)
 {
     Settings settings;
     Tokenizer tokenizer(&settings, NULL);
     std::istringstream istr(("(" + condition + ")").c_str());
-    tokenizer.tokenize(istr, "", "", true);
+    bool tokenized = tokenizer.tokenize(istr, "", "", true);
 
     if (Token::Match(tokenizer.tokens(), "( %var% )"))
     {
-        std::map<std::string,std::string>::const_iterator var = variables.find(tokenizer.tokens()->strAt(1));
+        std::map<std::string,std::string>::const_iterator var = findVariable(variables, tokenizer.tokens()->strAt(1), lookups);
         if (var != variables.end())
         {
             const std::string &value = (*var).second;
@@ -1403,16 +1465,16 @@ void Preprocessor::simplifyCondition(const std::map<std::string, std::string> &v
         }
         else if (match)
             condition = "0";
-        return;
+        return tokenized;
     }
 
     if (Token::Match(tokenizer.tokens(), "( ! %var% )"))
     {
-        if (variables.find(tokenizer.tokens()->strAt(2)) == variables.end())
+        if (findVariable(variables, tokenizer.tokens()->strAt(2), lookups) == variables.end())
             condition = "1";
         else if (match)
             condition = "0";
-        return;
+        return tokenized;
     }
 
     // replace variable names with values..
@@ -1423,7 +1485,7 @@ void Preprocessor::simplifyCondition(const std::map<std::string, std::string> &v
 
         if (Token::Match(tok, "defined ( %var% )"))
         {
-            if (variables.find(tok->strAt(2)) != variables.end())
+            if (findVariable(variables, tok->strAt(2), lookups) != variables.end())
                 tok->str("1");
             else if (match)
                 tok->str("0");
@@ -1437,7 +1499,7 @@ void Preprocessor::simplifyCondition(const std::map<std::string, std::string> &v
 
         if (Token::Match(tok, "defined %var%"))
         {
-            if (variables.find(tok->strAt(1)) != variables.end())
+            if (findVariable(variables, tok->strAt(1), lookups) != variables.end())
                 tok->str("1");
             else if (match)
                 tok->str("0");
@@ -1447,7 +1509,7 @@ void Preprocessor::simplifyCondition(const std::map<std::string, std::string> &v
             continue;
         }
 
-        const std::map<std::string, std::string>::const_iterator it = variables.find(tok->str());
+        const std::map<std::string, std::string>::const_iterator it = findVariable(variables, tok->str(), lookups);
         if (it != variables.end())
         {
             if (!it->second.empty())
@@ -1455,7 +1517,8 @@ void Preprocessor::simplifyCondition(const std::map<std::string, std::string> &v
                 // Tokenize the value
                 Tokenizer tokenizer2(&settings,NULL);
                 std::istringstream istr2(it->second);
-                tokenizer2.tokenize(istr2,"","",true);
+                if (!tokenizer2.tokenize(istr2,"","",true))
+                    tokenized = false;
 
                 // Copy the value tokens
                 std::stack<Token *> link;
@@ -1519,6 +1582,106 @@ void Preprocessor::simplifyCondition(const std::map<std::string, std::string> &v
         condition = "1";
     else if (Token::simpleMatch(tokenizer.tokens(), "( 0 )"))
         condition = "0";
+
+    return tokenized;
+}
+
+/**
+ * @brief Results of Preprocessor::simplifyCondition. Simplifying a
+ * condition tokenizes it, and the same conditions are found in the
+ * headers that all files include. A result is reused if the condition
+ * is the same and the variables that were looked up when it was
+ * simplified still have the same values. The cache is shared by all
+ * threads and files. It is cleared when it is full so that it doesn't
+ * grow without limit when many files are checked.
+ */
+class ConditionCache
+{
+public:
+    /** @brief max number of results, more results are not kept */
+    enum { MaxResults = 10000 };
+
+    /**
+     * @brief Get a result
+     * @param key the condition and the match flag
+     * @param variables Variable values
+     * @param condition the simplified condition is written here if it is found
+     * @return true if the result was found
+     */
+    bool find(const std::string &key, const std::map<std::string, std::string> &variables, std::string &condition)
+    {
+        Mutex::Lock lock(_mutex);
+        const std::map<std::string, Entry>::const_iterator it = _results.find(key);
+        if (it == _results.end())
+            return false;
+
+        const Entry &entry = it->second;
+        for (std::vector<Lookup>::const_iterator lookup = entry.lookups.begin(); lookup != entry.lookups.end(); ++lookup)
+        {
+            const std::map<std::string, std::string>::const_iterator var = variables.find(lookup->name);
+            if (var == variables.end() ? lookup->defined : (!lookup->defined || var->second != lookup->value))
+                return false;
+        }
+
+        condition = entry.result;
+        return true;
+    }
+
+    /** @brief Save the result and the values of the variables that were looked up */
+    void add(const std::string &key, const std::map<std::string, std::string> &variables, const std::set<std::string> &lookups, const std::string &condition)
+    {
+        Entry entry;
+        entry.result = condition;
+        for (std::set<std::string>::const_iterator name = lookups.begin(); name != lookups.end(); ++name)
+        {
+            Lookup lookup;
+            lookup.name = *name;
+            const std::map<std::string, std::string>::const_iterator var = variables.find(*name);
+            lookup.defined = bool(var != variables.end());
+            if (lookup.defined)
+                lookup.value = var->second;
+            entry.lookups.push_back(lookup);
+        }
+
+        Mutex::Lock lock(_mutex);
+        if (_results.size() >= static_cast<std::size_t>(MaxResults))
+            _results.clear();
+        _results[key] = entry;
+    }
+
+private:
+    struct Lookup
+    {
+        std::string name;
+        bool defined;
+        std::string value;
+    };
+
+    struct Entry
+    {
+        std::vector<Lookup> lookups;
+        std::string result;
+    };
+
+    Mutex _mutex;
+
+    /** @brief the latest result for each condition */
+    std::map<std::string, Entry> _results;
+};
+
+static ConditionCache conditionCache;
+
+void Preprocessor::simplifyCondition(const std::map<std::string, std::string> &variables, std::string &condition, bool match)
+{
+    const std::string key((match ? "1" : "0") + condition);
+    if (conditionCache.find(key, variables, condition))
+        return;
+
+    // Errors are written when a condition can't be tokenized, such
+    // conditions are simplified each time.
+    std::set<std::string> lookups;
+    if (simplifyConditionUncached(variables, condition, match, lookups))
+        conditionCache.add(key, variables, lookups, condition);
 }
 
 bool Preprocessor::match_cfg_def(const std::map<std::string, std::string> &cfg, std::string def)
@@ -1809,6 +1972,106 @@ static int tolowerWrapper(int c)
 }
 
 
+/**
+ * @brief Include files that have been looked up and read. The cache is
+ * shared by all Preprocessor instances so that a header included by many
+ * source files is only searched for and cleaned up once. It is used by
+ * the threads of ThreadExecutor at the same time and is therefore
+ * guarded by a mutex.
+ */
+class HeaderCache
+{
+public:
+    /**
+     * @brief Can the given path be opened? Both found and missing
+     * files are remembered.
+     */
+    bool exists(const std::string &path)
+    {
+        {
+            Mutex::Lock lock(_mutex);
+            const std::map<std::string, bool>::const_iterator it = _exists.find(path);
+            if (it != _exists.end())
+                return it->second;
+        }
+
+        std::ifstream fin(path.c_str());
+        const bool found = fin.is_open();
+
+        Mutex::Lock lock(_mutex);
+        _exists[path] = found;
+        return found;
+    }
+
+    /**
+     * @brief Get the text of a header after Preprocessor::read. The
+     * text is read again if the file has been modified.
+     * @param preprocessor preprocessor that reads the file
+     * @param path the (simplified) path of the header
+     * @param settings settings that are passed to Preprocessor::read
+     * @param cacheable false if reading the file has side effects
+     * on the settings, then the result is not stored
+     */
+    std::string read(Preprocessor &preprocessor, const std::string &path, Settings *settings, bool cacheable)
+    {
+        struct stat st;
+        if (::stat(path.c_str(), &st) != 0)
+            cacheable = false;
+
+        // "#error" is kept only when there are no user defines
+        const std::string key((settings && !settings->userDefines.empty() ? "D" : "-") + path);
+
+        if (cacheable)
+        {
+            Mutex::Lock lock(_mutex);
+            const std::map<std::string, Entry>::const_iterator it = _text.find(key);
+            if (it != _text.end() && it->second.mtime == st.st_mtime && it->second.size == st.st_size)
+                return it->second.text;
+        }
+
+        MappedFile fin;
+        if (!fin.open(path))
+            return "";
+
+        // Unhandled characters are reported while the file is read
+        for (std::size_t i = 0; cacheable && i < fin.size(); ++i)
+        {
+            if (fin.data()[i] & 0x80)
+                cacheable = false;
+        }
+
+        const std::string text(preprocessor.read(fin.data(), fin.size(), path, settings));
+
+        if (cacheable)
+        {
+            Mutex::Lock lock(_mutex);
+            Entry &entry = _text[key];
+            entry.mtime = st.st_mtime;
+            entry.size = st.st_size;
+            entry.text = text;
+        }
+        return text;
+    }
+
+private:
+    struct Entry
+    {
+        time_t mtime;
+        off_t size;
+        std::string text;
+    };
+
+    Mutex _mutex;
+
+    /** @brief paths that have been tried => can they be opened */
+    std::map<std::string, bool> _exists;
+
+    /** @brief header text, the key is the path with a prefix for the settings */
+    std::map<std::string, Entry> _text;
+};
+
+static HeaderCache headerCache;
+
 void Preprocessor::handleIncludes(std::string &code, const std::string &filePath, const std::list<std::string> &includePaths)
 {
     std::list<std::string> paths;
@@ -1851,29 +2114,24 @@ void Preprocessor::handleIncludes(std::string &code, const std::string &filePath
         // filename contains now a file name e.g. "menu.h"
         std::string processedFile;
         bool fileOpened = false;
-        std::ifstream fin;
         {
             std::list<std::string> includePaths2(includePaths);
             includePaths2.push_front("");
             for (std::list<std::string>::const_iterator iter = includePaths2.begin(); iter != includePaths2.end(); ++iter)
             {
                 const std::string nativePath(Path::toNativeSeparators(*iter));
-                fin.open((nativePath + filename).c_str());
-                if (fin.is_open())
+                if (headerCache.exists(nativePath + filename))
                 {
                     filename = nativePath + filename;
                     fileOpened = true;
                     break;
                 }
-
-                fin.clear();
             }
         }
 
         if (headerType == UserHeader && !fileOpened)
         {
-            fin.open((paths.back() + filename).c_str());
-            if (fin.is_open())
+            if (headerCache.exists(paths.back() + filename))
             {
                 filename = paths.back() + filename;
                 fileOpened = true;
@@ -1889,13 +2147,17 @@ void Preprocessor::handleIncludes(std::string &code, const std::string &filePath
             {
                 // We have processed this file already once, skip
                 // it this time to avoid eternal loop.
-                fin.close();
                 continue;
             }
 
             handledFiles.insert(tempFile);
-            processedFile = Preprocessor::read(fin, filename, _settings);
-            fin.close();
+
+            // Inline suppressions and fall through comments are added to
+            // the settings while the file is read
+            const bool cacheable = !_settings ||
+                                   (!_settings->_inlineSuppressions &&
+                                    !(_settings->_checkCodingStyle && _settings->inconclusive));
+            processedFile = headerCache.read(*this, filename, _settings, cacheable);
         }
 
         if (!processedFile.empty())
@@ -2088,14 +2350,109 @@ static void getparams(const std::string &line,
     }
 }
 
+class PreprocessorMacro;
+
+/**
+ * @brief The macros that are defined while the macros are expanded. This
+ * is a hash table so an identifier in the code can be looked up without
+ * copying it out of the line. The table owns the macros.
+ */
+class MacroTable
+{
+public:
+    MacroTable() : _buckets(64), _size(0)
+    { }
+
+    ~MacroTable();
+
+    /** @brief add macro. A macro that has the same name is deleted. */
+    void insert(PreprocessorMacro *macro);
+
+    /** @brief remove and delete the macro with the given name */
+    void erase(const std::string &name);
+
+    /**
+     * @brief find macro
+     * @param name start of the macro name
+     * @param length length of the macro name
+     * @return the macro or NULL if it isn't defined
+     */
+    const PreprocessorMacro *find(const char name[], std::string::size_type length) const
+    {
+        const std::vector<Entry> &bucket = _buckets[hash(name, length) & (_buckets.size() - 1)];
+        for (std::vector<Entry>::const_iterator it = bucket.begin(); it != bucket.end(); ++it)
+        {
+            if (it->name.size() == length && it->name.compare(0, length, name, length) == 0)
+                return it->macro;
+        }
+        return NULL;
+    }
+
+    const PreprocessorMacro *find(const std::string &name) const
+    {
+        return find(name.data(), name.size());
+    }
+
+private:
+    struct Entry
+    {
+        std::string name;
+        PreprocessorMacro *macro;
+    };
+
+    static std::size_t hash(const char name[], std::string::size_type length)
+    {
+        std::size_t h = 2166136261U;
+        for (std::string::size_type i = 0; i < length; ++i)
+            h = (h ^ static_cast<unsigned char>(name[i])) * 16777619U;
+        return h;
+    }
+
+    /** @brief the number of buckets is always a power of 2 */
+    std::vector< std::vector<Entry> > _buckets;
+
+    /** @brief number of macros */
+    std::size_t _size;
+
+    // Not implemented..
+    MacroTable(const MacroTable &);
+    void operator=(const MacroTable &);
+};
+
+/**
+ * @brief Macros that may not be expanded. When an inner macro is
+ * expanded it is hidden so it is not expanded again recursively.
+ */
+typedef std::vector<const PreprocessorMacro *> HiddenMacros;
+
 /** @brief Class that the preprocessor uses when it expands macros. This class represents a preprocessor macro */
 class PreprocessorMacro
 {
 private:
-    Settings settings;
+    /** @brief A token in the replacement list of the macro */
+    struct ReplacementToken
+    {
+        /** token text. The "#" of a stringified parameter is removed */
+        std::string str;
+
+        /** the token is "##" */
+        bool paste;
+
+        /** the token is a name or it begins with "#" */
+        bool name;
+
+        /** "#x" => the parameter is stringified */
+        bool stringify;
+
+        /** the token is a "," that is followed by "##" in a variadic macro */
+        bool optcomma;
 
-    /** tokens of this macro */
-    Tokenizer tokenizer;
+        /** add a space after the token so it is not glued to the next token */
+        bool space;
+
+        /** index of the parameter in _params, -1 if it isn't a parameter */
+        int param;
+    };
 
     /** macro parameters */
     std::vector<std::string> _params;
@@ -2109,43 +2466,61 @@ private:
     /** does this macro take a variable number of parameters? */
     bool _variadic;
 
-    /** prefix that is used by cppcheck to separate macro parameters. Always "__cppcheck__" */
-    const std::string _prefix;
-
     /** The macro has parentheses but no parameters.. "AAA()" */
     bool _nopar;
 
+    /** the replacement list of a macro with parameters */
+    std::vector<ReplacementToken> _replacement;
+
+    /** the code of a macro that has no parameters */
+    std::string _code;
+
+    /**
+     * The code that is used when the macro is used in the replacement
+     * list of another macro, if this macro doesn't have parentheses
+     */
+    std::string _innerCode;
+
+    /** The replacement list is another macro call "A(x,y) B(x,y)", name of the inner macro */
+    std::string _innerMacroName;
+
+    /** number of parameters of the inner macro call */
+    unsigned int _innerMacroParams;
+
     /** disabled assignment operator */
     void operator=(const PreprocessorMacro &);
 
-    /** @brief expand inner macro */
-    std::vector<std::string> expandInnerMacros(const std::vector<std::string> &params1,
-            const std::map<std::string, PreprocessorMacro *> &macros) const
+    /** @brief find macro that isn't hidden */
+    static const PreprocessorMacro *findMacro(const MacroTable &macros, const HiddenMacros &hidden, const std::string &name)
     {
-        std::string innerMacroName;
+        const PreprocessorMacro *macro = macros.find(name);
+        if (macro && std::find(hidden.begin(), hidden.end(), macro) != hidden.end())
+            return NULL;
+        return macro;
+    }
 
+    /**
+     * @brief expand inner macro
+     * @param params1 the given parameters
+     * @param macros macro definitions
+     * @param hidden macros that may not be expanded
+     * @param params2 the parameters after the inner macros are expanded
+     * @return false if there is no inner macro, then params2 is not set
+     */
+    bool expandInnerMacros(const std::vector<std::string> &params1,
+                           const MacroTable &macros,
+                           const HiddenMacros &hidden,
+                           std::vector<std::string> &params2) const
+    {
         // Is there an inner macro..
-        {
-            const Token *tok = Token::findmatch(tokens(), ")");
-            if (!Token::Match(tok, ") %var% ("))
-                return params1;
-            innerMacroName = tok->strAt(1);
-            tok = tok->tokAt(3);
-            unsigned int par = 0;
-            while (Token::Match(tok, "%var% ,|)"))
-            {
-                tok = tok->tokAt(2);
-                par++;
-            }
-            if (tok || par != params1.size())
-                return params1;
-        }
+        if (_innerMacroName.empty() || _innerMacroParams != params1.size())
+            return false;
 
-        std::vector<std::string> params2(params1);
+        params2 = params1;
 
         for (unsigned int ipar = 0; ipar < params1.size(); ++ipar)
         {
-            const std::string s(innerMacroName + "(");
+            const std::string s(_innerMacroName + "(");
             std::string param(params1[ipar]);
             if (param.compare(0,s.length(),s)==0 && param[param.length()-1]==')')
             {
@@ -2157,23 +2532,21 @@ private:
                 if (pos == param.length()-1 && num==0 && endFound && innerparams.size() == params1.size())
                 {
                     // Is inner macro defined?
-                    std::map<std::string, PreprocessorMacro *>::const_iterator it = macros.find(innerMacroName);
-                    if (it != macros.end())
+                    const PreprocessorMacro *innerMacro = findMacro(macros, hidden, _innerMacroName);
+                    if (innerMacro)
                     {
                         // expand the inner macro
-                        const PreprocessorMacro *innerMacro = it->second;
-
                         std::string innercode;
-                        std::map<std::string,PreprocessorMacro *> innermacros = macros;
-                        innermacros.erase(innerMacroName);
-                        innerMacro->code(innerparams, innermacros, innercode);
+                        HiddenMacros innerhidden(hidden);
+                        innerhidden.push_back(innerMacro);
+                        innerMacro->code(innerparams, macros, innerhidden, innercode);
                         params2[ipar] = innercode;
                     }
                 }
             }
         }
 
-        return params2;
+        return true;
     }
 
 public:
@@ -2184,17 +2557,17 @@ public:
      * e.g. "A(x) foo(x);"
      */
     PreprocessorMacro(const std::string &macro)
-        : _macro(macro), _prefix("__cppcheck__")
+        : _macro(macro), _innerMacroParams(0)
     {
-        tokenizer.setSettings(&settings);
-
         // Tokenize the macro to make it easier to handle
+        Tokenizer tokenizer;
         std::istringstream istr(macro.c_str());
         tokenizer.createTokens(istr);
+        const Token * const tokens = tokenizer.tokens();
 
         // macro name..
-        if (tokens() && tokens()->isName())
-            _name = tokens()->str();
+        if (tokens && tokens->isName())
+            _name = tokens->str();
 
         // initialize parameters to default values
         _variadic = _nopar = false;
@@ -2203,9 +2576,9 @@ public:
         if (pos != std::string::npos && macro[pos] == '(')
         {
             // Extract macro parameters
-            if (Token::Match(tokens(), "%var% ( %var%"))
+            if (Token::Match(tokens, "%var% ( %var%"))
             {
-                for (const Token *tok = tokens()->tokAt(2); tok; tok = tok->next())
+                for (const Token *tok = tokens->tokAt(2); tok; tok = tok->next())
                 {
                     if (tok->str() == ")")
                         break;
@@ -2221,18 +2594,94 @@ public:
                 }
             }
 
-            else if (Token::Match(tokens(), "%var% ( . . . )"))
+            else if (Token::Match(tokens, "%var% ( . . . )"))
                 _variadic = true;
 
-            else if (Token::Match(tokens(), "%var% ( )"))
+            else if (Token::Match(tokens, "%var% ( )"))
                 _nopar = true;
         }
-    }
 
-    /** return tokens of this macro */
-    const Token *tokens() const
-    {
-        return tokenizer.tokens();
+        if (_nopar || (_params.empty() && _variadic))
+        {
+            _code = _macro.substr(1 + _macro.find(")"));
+            if (!_code.empty())
+            {
+                // Remove leading spaces
+                if ((pos = _code.find_first_not_of(" ")) > 0)
+                    _code.erase(0, pos);
+                // Remove ending newline
+                if ((pos = _code.find_first_of("\r\n")) != std::string::npos)
+                    _code.erase(pos);
+            }
+        }
+
+        else if (_params.empty())
+        {
+            pos = _macro.find_first_of(" \"");
+            if (pos != std::string::npos)
+            {
+                if (_macro[pos] == ' ')
+                    pos++;
+                _code = _macro.substr(pos);
+                if ((pos = _code.find_first_of("\r\n")) != std::string::npos)
+                    _code.erase(pos);
+            }
+        }
+
+        else
+        {
+            // Is the replacement list an inner macro call..
+            const Token *tok = Token::findmatch(tokens, ")");
+            if (Token::Match(tok, ") %var% ("))
+            {
+                const std::string innerMacroName(tok->strAt(1));
+                tok = tok->tokAt(3);
+                unsigned int par = 0;
+                while (Token::Match(tok, "%var% ,|)"))
+                {
+                    tok = tok->tokAt(2);
+                    par++;
+                }
+                if (!tok)
+                {
+                    _innerMacroName = innerMacroName;
+                    _innerMacroParams = par;
+                }
+            }
+
+            // the replacement list..
+            tok = tokens;
+            while (tok && tok->str() != ")")
+                tok = tok->next();
+            while (tok && (tok = tok->next()) != NULL)
+            {
+                ReplacementToken rt;
+                rt.str = tok->str();
+                rt.paste = bool(rt.str == "##");
+                rt.name = bool(rt.str[0] == '#' || tok->isName());
+                rt.stringify = bool(rt.str[0] == '#');
+                if (rt.stringify)
+                    rt.str.erase(0, 1);
+                rt.param = -1;
+                for (unsigned int i = 0; rt.name && i < _params.size(); ++i)
+                {
+                    if (rt.str == _params[i])
+                    {
+                        rt.param = static_cast<int>(i);
+                        break;
+                    }
+                }
+                rt.optcomma = bool(_variadic && tok->str() == "," && tok->next() && tok->next()->str() == "##");
+                rt.space = bool(Token::Match(tok, "%var% %var%") ||
+                                Token::Match(tok, "%var% %num%") ||
+                                Token::Match(tok, "%num% %var%") ||
+                                Token::simpleMatch(tok, "> >"));
+                _replacement.push_back(rt);
+            }
+        }
+
+        if (_macro.find("(") == std::string::npos && _macro.find(" ") != std::string::npos)
+            _innerCode = _macro.substr(_macro.find(" "));
     }
 
     /** read parameters of this macro */
@@ -2263,25 +2712,18 @@ public:
      * get expanded code for this macro
      * @param params2 macro parameters
      * @param macros macro definitions (recursion)
+     * @param hidden macros that may not be expanded (recursion)
      * @param macrocode output string
      * @return true if the expanding was successful
      */
-    bool code(const std::vector<std::string> &params2, const std::map<std::string, PreprocessorMacro *> &macros, std::string &macrocode) const
+    bool code(const std::vector<std::string> &params2, const MacroTable &macros, const HiddenMacros &hidden, std::string &macrocode) const
     {
         if (_nopar || (_params.empty() && _variadic))
         {
-            macrocode = _macro.substr(1 + _macro.find(")"));
+            macrocode = _code;
             if (macrocode.empty())
                 return true;
 
-            std::string::size_type pos = 0;
-            // Remove leading spaces
-            if ((pos = macrocode.find_first_not_of(" ")) > 0)
-                macrocode.erase(0, pos);
-            // Remove ending newline
-            if ((pos = macrocode.find_first_of("\r\n")) != std::string::npos)
-                macrocode.erase(pos);
-
             // Replace "__VA_ARGS__" with parameters
             if (!_nopar)
             {
@@ -2293,7 +2735,7 @@ public:
                     s += params2[i];
                 }
 
-                pos = 0;
+                std::string::size_type pos = 0;
                 while ((pos = macrocode.find("__VA_ARGS__", pos)) != std::string::npos)
                 {
                     macrocode.erase(pos, 11);
@@ -2305,108 +2747,77 @@ public:
 
         else if (_params.empty())
         {
-            std::string::size_type pos = _macro.find_first_of(" \"");
-            if (pos == std::string::npos)
-                macrocode = "";
-            else
-            {
-                if (_macro[pos] == ' ')
-                    pos++;
-                macrocode = _macro.substr(pos);
-                if ((pos = macrocode.find_first_of("\r\n")) != std::string::npos)
-                    macrocode.erase(pos);
-            }
+            macrocode = _code;
         }
 
         else
         {
-            const std::vector<std::string> givenparams = expandInnerMacros(params2, macros);
+            std::vector<std::string> innerparams;
+            const std::vector<std::string> &givenparams = expandInnerMacros(params2, macros, hidden, innerparams) ? innerparams : params2;
 
-            const Token *tok = tokens();
-            while (tok && tok->str() != ")")
-                tok = tok->next();
-            if (tok)
+            bool optcomma = false;
+            for (std::vector<ReplacementToken>::const_iterator tok = _replacement.begin(); tok != _replacement.end(); ++tok)
             {
-                bool optcomma = false;
-                while ((tok = tok->next()) != NULL)
+                if (tok->paste)
+                    continue;
+
+                std::string str;
+                const std::string *s = &tok->str;
+                if (tok->name)
                 {
-                    std::string str = tok->str();
-                    if (str == "##")
-                        continue;
-                    if (str[0] == '#' || tok->isName())
+                    if (tok->param >= 0)
                     {
-                        const bool stringify(str[0] == '#');
-                        if (stringify)
-                        {
-                            str = str.erase(0, 1);
-                        }
-                        for (unsigned int i = 0; i < _params.size(); ++i)
+                        const unsigned int i = static_cast<unsigned int>(tok->param);
+                        if (_variadic &&
+                            (i == _params.size() - 1 ||
+                             (givenparams.size() + 2 == _params.size() && i + 1 == _params.size() - 1)))
                         {
-                            if (str == _params[i])
+                            for (unsigned int j = (unsigned int)_params.size() - 1; j < givenparams.size(); ++j)
                             {
-                                if (_variadic &&
-                                    (i == _params.size() - 1 ||
-                                     (givenparams.size() + 2 == _params.size() && i + 1 == _params.size() - 1)))
-                                {
-                                    str = "";
-                                    for (unsigned int j = (unsigned int)_params.size() - 1; j < givenparams.size(); ++j)
-                                    {
-                                        if (optcomma || j > _params.size() - 1)
-                                            str += ",";
-                                        optcomma = false;
-                                        str += givenparams[j];
-                                    }
-                                }
-                                else if (i >= givenparams.size())
-                                {
-                                    // Macro had more parameters than caller used.
-                                    macrocode = "";
-                                    return false;
-                                }
-                                else if (stringify)
-                                {
-                                    const std::string &s(givenparams[i]);
-                                    std::ostringstream ostr;
-                                    ostr << "\"";
-                                    for (std::string::size_type j = 0; j < s.size(); ++j)
-                                    {
-                                        if (s[j] == '\\' || s[j] == '\"')
-                                            ostr << '\\';
-                                        ostr << s[j];
-                                    }
-                                    str = ostr.str() + "\"";
-                                }
-                                else
-                                    str = givenparams[i];
-
-                                break;
+                                if (optcomma || j > _params.size() - 1)
+                                    str += ",";
+                                optcomma = false;
+                                str += givenparams[j];
                             }
+                            s = &str;
                         }
-
-                        // expand nopar macro
-                        const std::map<std::string, PreprocessorMacro *>::const_iterator it = macros.find(str);
-                        if (it != macros.end() && it->second->_macro.find("(") == std::string::npos)
+                        else if (i >= givenparams.size())
                         {
-                            str = it->second->_macro;
-                            if (str.find(" ") != std::string::npos)
-                                str.erase(0, str.find(" "));
-                            else
-                                str = "";
+                            // Macro had more parameters than caller used.
+                            macrocode = "";
+                            return false;
                         }
+                        else if (tok->stringify)
+                        {
+                            const std::string &p(givenparams[i]);
+                            str = "\"";
+                            for (std::string::size_type j = 0; j < p.size(); ++j)
+                            {
+                                if (p[j] == '\\' || p[j] == '\"')
+                                    str += '\\';
+                                str += p[j];
+                            }
+                            str += "\"";
+                            s = &str;
+                        }
+                        else
+                            s = &givenparams[i];
                     }
-                    if (_variadic && tok->str() == "," && tok->next() && tok->next()->str() == "##")
-                    {
-                        optcomma = true;
-                        continue;
-                    }
-                    optcomma = false;
-                    macrocode += str;
-                    if (Token::Match(tok, "%var% %var%") ||
-                        Token::Match(tok, "%var% %num%") ||
-                        Token::Match(tok, "%num% %var%") ||
-                        Token::simpleMatch(tok, "> >"))
-                        macrocode += " ";
+
+                    // expand nopar macro
+                    const PreprocessorMacro *macro = findMacro(macros, hidden, *s);
+                    if (macro && macro->_macro.find("(") == std::string::npos)
+                        s = &macro->_innerCode;
+                }
+                if (tok->optcomma)
+                {
+                    optcomma = true;
+                    continue;
                 }
+                optcomma = false;
+                macrocode += *s;
+                if (tok->space)
+                    macrocode += " ";
             }
         }
 
@@ -2414,45 +2825,109 @@ public:
     }
 };
 
+MacroTable::~MacroTable()
+{
+    for (std::vector< std::vector<Entry> >::iterator bucket = _buckets.begin(); bucket != _buckets.end(); ++bucket)
+    {
+        for (std::vector<Entry>::iterator it = bucket->begin(); it != bucket->end(); ++it)
+            delete it->macro;
+    }
+}
+
+void MacroTable::insert(PreprocessorMacro *macro)
+{
+    const std::string &name = macro->name();
+    std::vector<Entry> &bucket = _buckets[hash(name.data(), name.size()) & (_buckets.size() - 1)];
+    for (std::vector<Entry>::iterator it = bucket.begin(); it != bucket.end(); ++it)
+    {
+        if (it->name == name)
+        {
+            delete it->macro;
+            it->macro = macro;
+            return;
+        }
+    }
+
+    Entry entry;
+    entry.name = name;
+    entry.macro = macro;
+    bucket.push_back(entry);
+
+    // Keep the buckets short
+    if (++_size > _buckets.size())
+    {
+        std::vector< std::vector<Entry> > buckets(2 * _buckets.size());
+        for (std::vector< std::vector<Entry> >::const_iterator b = _buckets.begin(); b != _buckets.end(); ++b)
+        {
+            for (std::vector<Entry>::const_iterator it = b->begin(); it != b->end(); ++it)
+                buckets[hash(it->name.data(), it->name.size()) & (buckets.size() - 1)].push_back(*it);
+        }
+        _buckets.swap(buckets);
+    }
+}
+
+void MacroTable::erase(const std::string &name)
+{
+    std::vector<Entry> &bucket = _buckets[hash(name.data(), name.size()) & (_buckets.size() - 1)];
+    for (std::vector<Entry>::iterator it = bucket.begin(); it != bucket.end(); ++it)
+    {
+        if (it->name == name)
+        {
+            delete it->macro;
+            bucket.erase(it);
+            --_size;
+            return;
+        }
+    }
+}
+
 /**
  * Get data from a input string. This is an extended version of std::getline.
  * The std::getline only get a single line at a time. It can therefore happen that it
  * contains a partial statement. This function ensures that the returned data
  * doesn't end in the middle of a statement. The "getlines" name indicate that
  * this function will return multiple lines if needed.
- * @param istr input stream
+ * @param code input string
+ * @param pos in: position where reading starts. out: position after the
+ * returned data. It is beyond code.size() when the end has been reached.
  * @param line output data
  * @return success
  */
-static bool getlines(std::istream &istr, std::string &line)
+static bool getlines(const std::string &code, std::string::size_type &pos, std::string &line)
 {
-    if (!istr.good())
+    if (pos > code.size())
         return false;
     line = "";
     int parlevel = 0;
-    for (char ch = (char)istr.get(); istr.good(); ch = (char)istr.get())
+    for (; pos < code.size(); ++pos)
     {
+        const char ch = code[pos];
         if (ch == '\'' || ch == '\"')
         {
             line += ch;
             char c = 0;
-            while (istr.good() && c != ch)
+            while (c != ch)
             {
                 if (c == '\\')
                 {
-                    c = (char)istr.get();
-                    if (!istr.good())
-                        return true;
+                    if (++pos >= code.size())
+                        break;
+                    c = code[pos];
                     line += c;
                 }
 
-                c = (char)istr.get();
-                if (!istr.good())
-                    return true;
+                if (++pos >= code.size())
+                    break;
+                c = code[pos];
                 if (c == '\n' && line.compare(0, 1, "#") == 0)
+                {
+                    ++pos;
                     return true;
+                }
                 line += c;
             }
+            if (pos >= code.size())
+                break;
             continue;
         }
         if (ch == '(')
@@ -2462,22 +2937,30 @@ static bool getlines(std::istream &istr, std::string &line)
         else if (ch == '\n')
         {
             if (line.compare(0, 1, "#") == 0)
+            {
+                ++pos;
                 return true;
+            }
 
-            if (istr.peek() == '#')
+            if (pos + 1 < code.size() && code[pos + 1] == '#')
             {
                 line += ch;
+                ++pos;
                 return true;
             }
         }
         else if (line.compare(0, 1, "#") != 0 && parlevel <= 0 && ch == ';')
         {
             line += ";";
+            ++pos;
             return true;
         }
 
         line += ch;
     }
+
+    // the end has been reached
+    ++pos;
     return true;
 }
 
@@ -2487,7 +2970,10 @@ std::string Preprocessor::expandMacros(const std::string &code, std::string file
     // --------------------------------------------
 
     // Available macros (key=macroname, value=macro).
-    std::map<std::string, PreprocessorMacro *> macros;
+    MacroTable macros;
+
+    // No macros are hidden when a macro in the code is expanded
+    const HiddenMacros noHiddenMacros;
 
     // Current line number
     unsigned int linenr = 1;
@@ -2495,13 +2981,14 @@ std::string Preprocessor::expandMacros(const std::string &code, std::string file
     // linenr, filename
     std::stack< std::pair<unsigned int, std::string> > fileinfo;
 
-    // output stream
-    std::ostringstream ostr;
+    // output
+    std::string result;
+    result.reserve(code.size());
 
     // read code..
-    std::istringstream istr(code.c_str());
+    std::string::size_type codePos = 0;
     std::string line;
-    while (getlines(istr, line))
+    while (getlines(code, codePos, line))
     {
         // defining a macro..
         if (line.compare(0, 8, "#define ") == 0)
@@ -2510,26 +2997,14 @@ std::string Preprocessor::expandMacros(const std::string &code, std::string file
             if (macro->name().empty())
                 delete macro;
             else
-            {
-                std::map<std::string, PreprocessorMacro *>::iterator it;
-                it = macros.find(macro->name());
-                if (it != macros.end())
-                    delete it->second;
-                macros[macro->name()] = macro;
-            }
+                macros.insert(macro);
             line = "\n";
         }
 
         // undefining a macro..
         else if (line.compare(0, 7, "#undef ") == 0)
         {
-            std::map<std::string, PreprocessorMacro *>::iterator it;
-            it = macros.find(line.substr(7));
-            if (it != macros.end())
-            {
-                delete it->second;
-                macros.erase(it);
-            }
+            macros.erase(line.substr(7));
             line = "\n";
         }
 
@@ -2606,10 +3081,6 @@ std::string Preprocessor::expandMacros(const std::string &code, std::string file
                                    "noQuoteCharPair",
                                    std::string("No pair for character (") + ch + "). Can't process file. File is either invalid or unicode, which is currently not supported.");
 
-                        std::map<std::string, PreprocessorMacro *>::iterator it;
-                        for (it = macros.begin(); it != macros.end(); ++it)
-                            delete it->second;
-
                         return "";
                     }
 
@@ -2630,17 +3101,11 @@ std::string Preprocessor::expandMacros(const std::string &code, std::string file
                     while (pos < line.size() && (std::isalnum(line[pos]) || line[pos] == '_'))
                         ++pos;
 
-                    // get identifier
-                    const std::string id = line.substr(pos1, pos - pos1);
-
                     // is there a macro with this name?
-                    std::map<std::string, PreprocessorMacro *>::const_iterator it;
-                    it = macros.find(id);
-                    if (it == macros.end())
+                    const PreprocessorMacro * const macro = macros.find(line.data() + pos1, pos - pos1);
+                    if (!macro)
                         break;  // no macro with this name exist
 
-                    const PreprocessorMacro * const macro = it->second;
-
                     // check that pos is within allowed limits for this
                     // macro
                     {
@@ -2682,7 +3147,7 @@ std::string Preprocessor::expandMacros(const std::string &code, std::string file
 
                     // Create macro code..
                     std::string tempMacro;
-                    if (!macro->code(params, macros, tempMacro))
+                    if (!macro->code(params, macros, noHiddenMacros, tempMacro))
                     {
                         // Syntax error in code
                         writeError(filename,
@@ -2691,10 +3156,6 @@ std::string Preprocessor::expandMacros(const std::string &code, std::string file
                                    "syntaxError",
                                    std::string("Syntax error. Not enough parameters for macro '") + macro->name() + "'.");
 
-                        std::map<std::string, PreprocessorMacro *>::iterator iter;
-                        for (iter = macros.begin(); iter != macros.end(); ++iter)
-                            delete iter->second;
-
                         return "";
                     }
 
@@ -2739,8 +3200,8 @@ std::string Preprocessor::expandMacros(const std::string &code, std::string file
             }
         }
 
-        // the line has been processed in various ways. Now add it to the output stream
-        ostr << line;
+        // the line has been processed in various ways. Now add it to the output
+        result += line;
 
         // update linenr
         for (std::string::size_type p = 0; p < line.length(); ++p)
@@ -2750,13 +3211,7 @@ std::string Preprocessor::expandMacros(const std::string &code, std::string file
         }
     }
 
-    {
-        std::map<std::string, PreprocessorMacro *>::iterator it;
-        for (it = macros.begin(); it != macros.end(); ++it)
-            delete it->second;
-    }
-
-    return ostr.str();
+    return result;
 }
 
 
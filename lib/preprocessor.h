@@ -21,6 +21,7 @@
 #define preprocessorH
 //---------------------------------------------------------------------------
 
+#include <cstddef>
 #include <map>
 #include <istream>
 #include <string>
@@ -85,9 +86,21 @@ public:
      */
     void preprocess(std::istream &srcCodeStream, std::string &processedFile, std::list<std::string> &resultConfigurations, const std::string &filename, const std::list<std::string> &includePaths);
 
+    /**
+     * Extract the code for each configuration from code in memory,
+     * e.g. a file that has been mapped with MappedFile.
+     * @param data The code. It does not need to be null terminated.
+     * @param size The size of the code
+     * See the other preprocess() for the other parameters.
+     */
+    void preprocess(const char data[], std::size_t size, std::string &processedFile, std::list<std::string> &resultConfigurations, const std::string &filename, const std::list<std::string> &includePaths);
+
     /** Just read the code into a string. Perform simple cleanup of the code */
     std::string read(std::istream &istr, const std::string &filename, Settings *settings);
 
+    /** Read the code from memory into a string. Perform simple cleanup of the code */
+    std::string read(const char data[], std::size_t size, const std::string &filename, Settings *settings);
+
     /**
      * Get preprocessed code for a given configuration
      */
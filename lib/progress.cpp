@@ -0,0 +1,156 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "progress.h"
+#include "errorlogger.h"
+
+#include <list>
+#include <vector>
+
+/** @brief Protects the running stages and their values */
+static Mutex progressMutex;
+
+/** @brief The stages that are running, only stored when there are reporters */
+static std::list<const Progress *> stages;
+
+/**
+ * @brief Number of started reporters. It is read and changed atomically,
+ * so a stage doesn't take the lock when nothing is reported.
+ */
+static volatile long reporters = 0;
+
+/** @brief The progress of a stage when it was sampled */
+struct Sample
+{
+    Sample(const std::string &f, const char s[], unsigned int v)
+        : filename(f), stage(s), value(v)
+    { }
+
+    std::string filename;
+    const char *stage;
+    unsigned int value;
+};
+
+Progress::Progress(const std::string &filename, const char stage[])
+    : _stage(stage), _value(0), _lastValue(0), _registered(false)
+{
+    if (Thread::fetchAndAdd(reporters, 0) == 0)
+        return;
+
+    Mutex::Lock lock(progressMutex);
+    _filename = filename;
+    stages.push_back(this);
+    _registered = true;
+}
+
+void Progress::publish(unsigned int value)
+{
+    _lastValue = value;
+    Mutex::Lock lock(progressMutex);
+    _value = value;
+}
+
+Progress::~Progress()
+{
+    if (!_registered)
+        return;
+
+    Mutex::Lock lock(progressMutex);
+    stages.remove(this);
+}
+
+ProgressReporter::ProgressReporter(ErrorLogger &errorLogger)
+    : _errorLogger(errorLogger), _interval(0), _stop(false), _started(false)
+{
+}
+
+ProgressReporter::~ProgressReporter()
+{
+    stop();
+}
+
+bool ProgressReporter::start(unsigned int interval)
+{
+    if (_started)
+        return true;
+
+    _interval = interval > 0 ? interval : 1;
+    {
+        Mutex::Lock lock(progressMutex);
+        _stop = false;
+    }
+    Thread::fetchAndAdd(reporters, 1);
+    _started = _thread.start(run, this);
+    if (!_started)
+        Thread::fetchAndAdd(reporters, -1);
+    return _started;
+}
+
+void ProgressReporter::stop()
+{
+    if (!_started)
+        return;
+
+    {
+        Mutex::Lock lock(progressMutex);
+        _stop = true;
+    }
+    _thread.join();
+    _started = false;
+
+    Thread::fetchAndAdd(reporters, -1);
+}
+
+bool ProgressReporter::stopping() const
+{
+    Mutex::Lock lock(progressMutex);
+    return _stop;
+}
+
+void ProgressReporter::report()
+{
+    // Take a snapshot, the stages must not wait for the output
+    std::vector<Sample> samples;
+    {
+        Mutex::Lock lock(progressMutex);
+        for (std::list<const Progress *>::const_iterator it = stages.begin(); it != stages.end(); ++it)
+            samples.push_back(Sample((*it)->_filename, (*it)->_stage, (*it)->_value));
+    }
+
+    for (std::vector<Sample>::const_iterator it = samples.begin(); it != samples.end(); ++it)
+        _errorLogger.reportProgress(it->filename, it->stage, it->value);
+}
+
+void ProgressReporter::run(void *reporter)
+{
+    ProgressReporter * const self = static_cast<ProgressReporter *>(reporter);
+
+    // Sleep in short steps so stop() does not have to wait long
+    const unsigned int step = self->_interval < 100 ? self->_interval : 100;
+    unsigned int elapsed = 0;
+    while (!self->stopping())
+    {
+        Thread::sleep(step);
+        elapsed += step;
+        if (elapsed >= self->_interval && !self->stopping())
+        {
+            elapsed = 0;
+            self->report();
+        }
+    }
+}
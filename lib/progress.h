@@ -0,0 +1,132 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+//---------------------------------------------------------------------------
+#ifndef progressH
+#define progressH
+//---------------------------------------------------------------------------
+
+#include <string>
+#include "threading.h"
+
+class ErrorLogger;
+
+/// @addtogroup Core
+/// @{
+
+/**
+ * @brief Progress of a stage of the checking (--report-progress).
+ *
+ * A loop that handles a stage only stores its progress value in the
+ * Progress. That is much cheaper than calling
+ * ErrorLogger::reportProgress() for every token. The stages are sampled
+ * by a ProgressReporter in a thread of its own. The value is published
+ * under a lock, which is only taken when a ProgressReporter is running
+ * and the value changes.
+ */
+class Progress
+{
+public:
+    /**
+     * @brief Start a stage. Nothing is done if no ProgressReporter is running.
+     * @param filename main file that is checked
+     * @param stage for example "Tokenize (typedef)"
+     */
+    Progress(const std::string &filename, const char stage[]);
+
+    /** @brief End the stage */
+    ~Progress();
+
+    /** @brief Set the progress value (0-100) */
+    void value(unsigned int value)
+    {
+        if (_registered && value != _lastValue)
+            publish(value);
+    }
+
+private:
+    friend class ProgressReporter;
+
+    /** @brief Publish a new value to the reporters */
+    void publish(unsigned int value);
+
+    std::string _filename;
+    const char * const _stage;
+
+    /** @brief the reported value, protected by the lock of the stages */
+    unsigned int _value;
+
+    /** @brief the last value that was published, only used by the owner */
+    unsigned int _lastValue;
+
+    bool _registered;
+
+    // Not implemented..
+    Progress(const Progress &);
+    void operator=(const Progress &);
+};
+
+/**
+ * @brief Reports the progress of the running stages to an ErrorLogger.
+ */
+class ProgressReporter
+{
+public:
+    explicit ProgressReporter(ErrorLogger &errorLogger);
+
+    /** @brief Stops reporting */
+    ~ProgressReporter();
+
+    /**
+     * @brief Start reporting the progress in a thread of its own.
+     * Stages that start after this are reported.
+     * @param interval milliseconds between the reports
+     * @return false if the thread could not be started
+     */
+    bool start(unsigned int interval);
+
+    /** @brief Stop reporting the progress */
+    void stop();
+
+    /** @brief Report the progress of the running stages now */
+    void report();
+
+private:
+    /** @brief Thread function that reports the progress */
+    static void run(void *reporter);
+
+    /** @brief Has stop() been called? */
+    bool stopping() const;
+
+    ErrorLogger &_errorLogger;
+    unsigned int _interval;
+
+    /** @brief protected by the lock of the stages */
+    bool _stop;
+    bool _started;
+    Thread _thread;
+
+    // Not implemented..
+    ProgressReporter(const ProgressReporter &);
+    void operator=(const ProgressReporter &);
+};
+
+/// @}
+
+//---------------------------------------------------------------------------
+#endif
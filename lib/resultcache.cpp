@@ -0,0 +1,257 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resultcache.h"
+#include "settings.h"
+#include "cppcheck.h"
+#include "hash.h"
+#include "threading.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <unistd.h>
+#endif
+
+#include <cstdio>
+#include <fstream>
+#include <sstream>
+#include <iomanip>
+
+/** First line in the cache files */
+static const char cacheFileHeader[] = "cppcheck results";
+
+/** First line in the analysis files */
+static const char analysisFileHeader[] = "cppcheck analysis";
+
+ResultCache::ResultCache(const std::string &directory)
+    : _directory(directory)
+{
+    if (!_directory.empty() && _directory[_directory.length() - 1] != '/' && _directory[_directory.length() - 1] != '\\')
+        _directory += '/';
+}
+
+std::string ResultCache::key(const Settings &settings,
+                             const std::string &filename,
+                             const std::string &filedata,
+                             const std::list<std::string> &configurations)
+{
+    // Settings that have an effect on the results..
+    std::ostringstream ostr;
+    ostr << CppCheck::version() << '\n'
+         << filename << '\n'
+         << settings._checkCodingStyle
+         << settings.isEnabled("information")
+         << settings.isEnabled("missingInclude")
+         << settings.isEnabled("unusedFunction")
+         << settings.inconclusive
+         << settings.debug
+         << settings.debugwarnings
+         << settings._force << '\n'
+         << settings.userDefines << '\n'
+         << settings.append() << '\n';
+    for (std::list<std::string>::const_iterator it = settings._includePaths.begin(); it != settings._includePaths.end(); ++it)
+        ostr << "-I" << *it << '\n';
+    for (std::list<Settings::Rule>::const_iterator it = settings.rules.begin(); it != settings.rules.end(); ++it)
+        ostr << "rule " << it->pattern << '\n' << it->id << '\n' << it->severity << '\n' << it->summary << '\n';
+    for (std::list<std::string>::const_iterator it = configurations.begin(); it != configurations.end(); ++it)
+        ostr << "cfg " << *it << '\n';
+
+    std::ostringstream ret;
+    ret << std::hex << std::setw(16) << std::setfill('0') << fnv1aHash(filedata, fnv1aHash(ostr.str()));
+    return ret.str();
+}
+
+std::string ResultCache::path(const std::string &key, const char extension[]) const
+{
+    return _directory + key + extension;
+}
+
+/**
+ * Replace the file with the data. The data is written to a temporary
+ * file in the same directory that is then renamed, so other threads and
+ * processes never read a partly written file.
+ */
+static void writeFile(const std::string &filename, const std::string &data)
+{
+    // The temporary file name must be unique for each thread and process
+    static Mutex counterMutex;
+    static unsigned int counter = 0;
+    unsigned int number;
+    {
+        Mutex::Lock lock(counterMutex);
+        number = ++counter;
+    }
+
+    std::ostringstream tempname;
+#ifdef _WIN32
+    tempname << filename << ".tmp" << _getpid() << '.' << number;
+#else
+    tempname << filename << ".tmp" << getpid() << '.' << number;
+#endif
+
+    {
+        std::ofstream fout(tempname.str().c_str(), std::ios::out | std::ios::binary | std::ios::trunc);
+        if (!fout.is_open())
+            return;
+        fout << data;
+        fout.close();
+        if (fout.fail())
+        {
+            std::remove(tempname.str().c_str());
+            return;
+        }
+    }
+
+#ifdef _WIN32
+    const bool renamed = MoveFileExA(tempname.str().c_str(), filename.c_str(), MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    const bool renamed = std::rename(tempname.str().c_str(), filename.c_str()) == 0;
+#endif
+    if (!renamed)
+        std::remove(tempname.str().c_str());
+}
+
+/** Read data that was written as "<length>\n<data>" */
+static bool readData(std::istream &fin, std::string &data)
+{
+    std::string::size_type length = 0;
+    if (!(fin >> length) || fin.get() != '\n')
+        return false;
+
+    data.assign(length, '\0');
+    return length == 0 || fin.read(&data[0], static_cast<std::streamsize>(length));
+}
+
+bool ResultCache::load(const std::string &key, const std::string &filename, std::list<Result> &results,
+                       std::list<CheckUnusedFunctions::Summary> *usage) const
+{
+    std::ifstream fin(path(key).c_str(), std::ios::in | std::ios::binary);
+    if (!fin.is_open())
+        return false;
+
+    std::string line;
+    if (!std::getline(fin, line) || line != cacheFileHeader)
+        return false;
+
+    // Different files might have the same key
+    if (!std::getline(fin, line) || line != filename)
+        return false;
+
+    unsigned int count = 0;
+    if (!(fin >> count))
+        return false;
+
+    std::list<Result> loaded;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        char kind = 0;
+        std::string::size_type length = 0;
+        if (!(fin >> kind >> length) || (kind != 'D' && kind != 'R') || fin.get() != '\n')
+            return false;
+
+        std::string data(length, '\0');
+        if (length > 0 && !fin.read(&data[0], static_cast<std::streamsize>(length)))
+            return false;
+
+        ErrorLogger::ErrorMessage msg;
+        if (!msg.deserialize(data))
+            return false;
+        loaded.push_back(Result(kind == 'D', msg));
+    }
+
+    // The defined and used functions are saved after the results
+    std::list<CheckUnusedFunctions::Summary> loadedUsage;
+    if (usage)
+    {
+        std::string section, data;
+        if (!(fin >> section) || section != "usage" || !readData(fin, data) ||
+            !CheckUnusedFunctions::deserialize(data, loadedUsage))
+            return false;
+        usage->splice(usage->end(), loadedUsage);
+    }
+
+    results.splice(results.end(), loaded);
+    return true;
+}
+
+void ResultCache::save(const std::string &key, const std::string &filename, const std::list<Result> &results,
+                       const std::list<CheckUnusedFunctions::Summary> *usage) const
+{
+    std::ostringstream fout;
+    fout << cacheFileHeader << '\n'
+         << filename << '\n'
+         << results.size() << '\n';
+    for (std::list<Result>::const_iterator it = results.begin(); it != results.end(); ++it)
+    {
+        const std::string data(it->_msg.serialize());
+        fout << (it->_direct ? 'D' : 'R') << ' ' << data.length() << '\n' << data << '\n';
+    }
+
+    if (usage)
+    {
+        const std::string data(CheckUnusedFunctions::serialize(*usage));
+        fout << "usage " << data.length() << '\n' << data << '\n';
+    }
+
+    writeFile(path(key), fout.str());
+}
+
+bool ResultCache::loadAnalysis(const std::string &key, const std::string &filename, std::set<std::string> &data) const
+{
+    std::ifstream fin(path(key, ".analysis").c_str(), std::ios::in | std::ios::binary);
+    if (!fin.is_open())
+        return false;
+
+    std::string line;
+    if (!std::getline(fin, line) || line != analysisFileHeader)
+        return false;
+
+    // Different files might have the same key
+    if (!std::getline(fin, line) || line != filename)
+        return false;
+
+    unsigned int count = 0;
+    if (!(fin >> count))
+        return false;
+
+    std::set<std::string> loaded;
+    for (unsigned int i = 0; i < count; ++i)
+    {
+        std::string str;
+        if (!readData(fin, str))
+            return false;
+        loaded.insert(str);
+    }
+
+    data.insert(loaded.begin(), loaded.end());
+    return true;
+}
+
+void ResultCache::saveAnalysis(const std::string &key, const std::string &filename, const std::set<std::string> &data) const
+{
+    std::ostringstream fout;
+    fout << analysisFileHeader << '\n'
+         << filename << '\n'
+         << data.size() << '\n';
+    for (std::set<std::string>::const_iterator it = data.begin(); it != data.end(); ++it)
+        fout << it->length() << '\n' << *it << '\n';
+
+    writeFile(path(key, ".analysis"), fout.str());
+}
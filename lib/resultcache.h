@@ -0,0 +1,137 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef resultcacheH
+#define resultcacheH
+
+#include "errorlogger.h"
+#include "checkunusedfunctions.h"
+
+#include <list>
+#include <set>
+#include <string>
+
+class Settings;
+
+/// @addtogroup Core
+/// @{
+
+/**
+ * @brief On-disk cache of the errors reported for a source file (--cache-dir).
+ *
+ * The errors are saved in a file in the cache directory. The name of the
+ * file is a hash of everything that the results depend on: the
+ * preprocessed code (this includes the included headers), the
+ * configurations, the settings and the Cppcheck version. When a file is
+ * checked again and nothing has changed, the saved errors can be reported
+ * again without tokenizing and checking the file.
+ *
+ * The per-file data of the whole program analysis is saved too: the
+ * functions that the file defines and uses (unused functions) and the
+ * analysis data of --test-2-pass. Only the files that have changed have to
+ * be tokenized again, the global phase then uses the saved data.
+ */
+class ResultCache
+{
+public:
+    /** @brief A reported error */
+    class Result
+    {
+    public:
+        Result(bool direct, const ErrorLogger::ErrorMessage &msg)
+            : _direct(direct), _msg(msg)
+        { }
+
+        /**
+         * The error was given directly to the ErrorLogger of the CppCheck
+         * instance and not filtered (duplicates, suppressions).
+         */
+        bool _direct;
+
+        ErrorLogger::ErrorMessage _msg;
+    };
+
+    /**
+     * @brief Constructor
+     * @param directory the cache directory. It must exist.
+     */
+    explicit ResultCache(const std::string &directory);
+
+    /**
+     * @brief Calculate the key for the results of a file.
+     * @param settings settings that are used
+     * @param filename name of the source file
+     * @param filedata preprocessed code (Preprocessor::preprocess)
+     * @param configurations the configurations that are checked
+     * @return key, e.g. "0123456789abcdef"
+     */
+    static std::string key(const Settings &settings,
+                           const std::string &filename,
+                           const std::string &filedata,
+                           const std::list<std::string> &configurations);
+
+    /**
+     * @brief Load saved results
+     * @param key key calculated with key()
+     * @param filename name of the source file
+     * @param results the saved results are added here
+     * @param usage if given, the saved defined and used functions are added here
+     * @return true if the results (and the functions if usage is given) were found
+     */
+    bool load(const std::string &key, const std::string &filename, std::list<Result> &results,
+              std::list<CheckUnusedFunctions::Summary> *usage = 0) const;
+
+    /**
+     * @brief Save results. Errors are silently ignored, the results
+     * are then just not available the next time.
+     * @param key key calculated with key()
+     * @param filename name of the source file
+     * @param results the results to save
+     * @param usage if given, the defined and used functions are saved too
+     */
+    void save(const std::string &key, const std::string &filename, const std::list<Result> &results,
+              const std::list<CheckUnusedFunctions::Summary> *usage = 0) const;
+
+    /**
+     * @brief Load saved analysis data (--test-2-pass)
+     * @param key key calculated with key()
+     * @param filename name of the source file
+     * @param data the saved analysis data is added here
+     * @return true if the data was found
+     */
+    bool loadAnalysis(const std::string &key, const std::string &filename, std::set<std::string> &data) const;
+
+    /**
+     * @brief Save analysis data (--test-2-pass). Errors are silently ignored.
+     * @param key key calculated with key()
+     * @param filename name of the source file
+     * @param data the analysis data of the file
+     */
+    void saveAnalysis(const std::string &key, const std::string &filename, const std::set<std::string> &data) const;
+
+private:
+    /** @brief path of the cache file for the given key */
+    std::string path(const std::string &key, const char extension[] = ".results") const;
+
+    /** @brief the cache directory, ends with a '/' */
+    std::string _directory;
+};
+
+/// @}
+
+#endif
@@ -38,6 +38,7 @@ Settings::Settings()
     _xml = false;
     _xml_version = 1;
     _jobs = 1;
+    _processExecutor = false;
     _exitCode = 0;
     _showtime = 0; // TODO: use enum
     _append = "";
@@ -215,10 +216,12 @@ std::string Settings::Suppressions::FileMatcher::addFile(const std::string &name
             }
         }
         _globs[name][line] = false;
+        _matchingGlobs.clear();
     }
     else if (name.empty())
     {
         _globs["*"][0U] = false;
+        _matchingGlobs.clear();
     }
     else
     {
@@ -227,26 +230,49 @@ std::string Settings::Suppressions::FileMatcher::addFile(const std::string &name
     return "";
 }
 
+const std::vector<Settings::Suppressions::FileMatcher::SuppressedLines::iterator> &
+Settings::Suppressions::FileMatcher::matchingGlobs(const std::string &file)
+{
+    std::map<std::string, std::vector<SuppressedLines::iterator> >::iterator it = _matchingGlobs.find(file);
+    if (it != _matchingGlobs.end())
+        return it->second;
+
+    // The errors of a file are mostly reported together, the files that
+    // were seen long ago are just matched again if they are needed
+    if (_matchingGlobs.size() >= static_cast<std::size_t>(MaxMatchingGlobFiles))
+        _matchingGlobs.clear();
+
+    std::vector<SuppressedLines::iterator> &globs = _matchingGlobs[file];
+    for (SuppressedLines::iterator g = _globs.begin(); g != _globs.end(); ++g)
+    {
+        if (match(g->first, file))
+            globs.push_back(g);
+    }
+    return globs;
+}
+
 bool Settings::Suppressions::FileMatcher::isSuppressed(const std::string &file, unsigned int line)
 {
     if (isSuppressedLocal(file, line))
         return true;
 
-    for (std::map<std::string, std::map<unsigned int, bool> >::iterator g = _globs.begin(); g != _globs.end(); ++g)
+    if (_globs.empty())
+        return false;
+
+    const std::vector<SuppressedLines::iterator> &globs = matchingGlobs(file);
+    for (std::vector<SuppressedLines::iterator>::const_iterator it = globs.begin(); it != globs.end(); ++it)
     {
-        if (match(g->first, file))
+        std::map<unsigned int, bool> &lines = (*it)->second;
+        if (lines.find(0U) != lines.end())
         {
-            if (g->second.find(0U) != g->second.end())
-            {
-                g->second[0U] = true;
-                return true;
-            }
-            std::map<unsigned int, bool>::iterator l = g->second.find(line);
-            if (l != g->second.end())
-            {
-                l->second = true;
-                return true;
-            }
+            lines[0U] = true;
+            return true;
+        }
+        std::map<unsigned int, bool>::iterator l = lines.find(line);
+        if (l != lines.end())
+        {
+            l->second = true;
+            return true;
         }
     }
 
@@ -298,18 +324,20 @@ std::string Settings::Suppressions::addSuppression(const std::string &errorId, c
 
 bool Settings::Suppressions::isSuppressed(const std::string &errorId, const std::string &file, unsigned int line)
 {
-    if (_suppressions.find(errorId) == _suppressions.end())
+    const std::map<std::string, FileMatcher>::iterator it = _suppressions.find(errorId);
+    if (it == _suppressions.end())
         return false;
 
-    return _suppressions[errorId].isSuppressed(file, line);
+    return it->second.isSuppressed(file, line);
 }
 
 bool Settings::Suppressions::isSuppressedLocal(const std::string &errorId, const std::string &file, unsigned int line)
 {
-    if (_suppressions.find(errorId) == _suppressions.end())
+    const std::map<std::string, FileMatcher>::iterator it = _suppressions.find(errorId);
+    if (it == _suppressions.end())
         return false;
 
-    return _suppressions[errorId].isSuppressedLocal(file, line);
+    return it->second.isSuppressedLocal(file, line);
 }
 
 std::list<Settings::Suppressions::SuppressionEntry> Settings::Suppressions::getUnmatchedLocalSuppressions(const std::string &file) const
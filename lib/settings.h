@@ -24,6 +24,7 @@
 #include <istream>
 #include <map>
 #include <set>
+#include <vector>
 
 /// @addtogroup Core
 /// @{
@@ -95,6 +96,10 @@ public:
         time. Default is 1. (-j N) */
     unsigned int _jobs;
 
+    /** @brief Run the jobs in forked processes instead of threads
+        (--executor=process) */
+    bool _processExecutor;
+
     /** @brief If errors are found, this value is returned from main().
         Default value is 0. */
     int _exitCode;
@@ -103,13 +108,17 @@ public:
         e.g. "{severity} {file}:{line} {message} {id}" */
     std::string _outputFormat;
 
-    /** @brief show timing information (--showtime=file|summary|top5) */
+    /** @brief show timing information (--showtime=file|summary|top5|json) */
     unsigned int _showtime;
 
     /** @brief List of include paths, e.g. "my/includes/" which should be used
         for finding include files inside source files. (-I) */
     std::list<std::string> _includePaths;
 
+    /** @brief Directory where results are saved so unchanged files
+        don't need to be checked again (--cache-dir) */
+    std::string _cacheDir;
+
     /** @brief assign append code (--append) */
     void append(const std::string &filename);
 
@@ -140,10 +149,27 @@ public:
         {
             friend class Suppressions;
         private:
+            typedef std::map<std::string, std::map<unsigned int, bool> > SuppressedLines;
+
+            /** @brief Max number of files in _matchingGlobs */
+            enum { MaxMatchingGlobFiles = 1000 };
+
             /** @brief List of filenames suppressed, bool flag indicates whether suppression matched. */
-            std::map<std::string, std::map<unsigned int, bool> > _files;
+            SuppressedLines _files;
             /** @brief List of globs suppressed, bool flag indicates whether suppression matched. */
-            std::map<std::string, std::map<unsigned int, bool> > _globs;
+            SuppressedLines _globs;
+
+            /**
+             * @brief The globs that match a file, in _globs order. Each file
+             * is matched against the globs once, the following errors in the
+             * file are then just lookups. Cleared when a glob is added, and
+             * when it holds MaxMatchingGlobFiles files so it does not grow with
+             * the number of checked files.
+             */
+            std::map<std::string, std::vector<SuppressedLines::iterator> > _matchingGlobs;
+
+            /** @brief Get the globs that match a file */
+            const std::vector<SuppressedLines::iterator> &matchingGlobs(const std::string &file);
 
             /**
              * @brief Match a name against a glob pattern.
@@ -154,6 +180,22 @@ public:
             static bool match(const std::string &pattern, const std::string &name);
 
         public:
+            FileMatcher()
+            { }
+
+            /** The matching globs point into _globs, they are not copied */
+            FileMatcher(const FileMatcher &other)
+                : _files(other._files), _globs(other._globs)
+            { }
+
+            FileMatcher &operator=(const FileMatcher &other)
+            {
+                _files = other._files;
+                _globs = other._globs;
+                _matchingGlobs.clear();
+                return *this;
+            }
+
             /**
              * @brief Add a file or glob (and line number).
              * @param name File name or glob pattern
@@ -36,11 +36,11 @@
 //---------------------------------------------------------------------------
 
 SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *settings, ErrorLogger *errorLogger)
-    : _tokenizer(tokenizer), _settings(settings), _errorLogger(errorLogger)
+    : _tokenizer(tokenizer), _settings(settings), _errorLogger(errorLogger), _tokensVersion(tokenizer->tokensVersion())
 {
     // find all namespaces (class,struct and namespace)
     Scope *scope = new Scope(this, NULL, NULL);
-    scopeList.push_back(scope);
+    addScope(scope);
     for (const Token *tok = _tokenizer->tokens(); tok; tok = tok->next())
     {
         // Locate next class
@@ -79,7 +79,7 @@ SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *setti
             scope = new_scope;
 
             // add namespace
-            scopeList.push_back(scope);
+            addScope(scope);
 
             tok = tok2;
         }
@@ -406,20 +406,20 @@ SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *setti
                 {
                     scope = new Scope(this, tok, scope, Scope::eIf, tok->next()->link()->next());
                     tok = tok->next()->link()->next();
-                    scopeList.push_back(scope);
+                    addScope(scope);
                 }
                 else if (Token::simpleMatch(tok, "else {"))
                 {
                     scope = new Scope(this, tok, scope, Scope::eElse, tok->next());
                     tok = tok->next();
-                    scopeList.push_back(scope);
+                    addScope(scope);
                 }
                 else if (Token::simpleMatch(tok, "else if (") &&
                          Token::simpleMatch(tok->next()->next()->link(), ") {"))
                 {
                     scope = new Scope(this, tok, scope, Scope::eElseIf, tok->next()->next()->link()->next());
                     tok = tok->next()->next()->link()->next();
-                    scopeList.push_back(scope);
+                    addScope(scope);
                 }
                 else if (Token::simpleMatch(tok, "for (") &&
                          Token::simpleMatch(tok->next()->link(), ") {"))
@@ -428,7 +428,7 @@ SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *setti
                     const Token *tok1 = tok->tokAt(2);
                     scope = new Scope(this, tok, scope, Scope::eFor, tok->next()->link()->next());
                     tok = tok->next()->link()->next();
-                    scopeList.push_back(scope);
+                    addScope(scope);
                     // check for variable declaration and add it to new scope if found
                     scope->checkVariable(tok1, Local);
                 }
@@ -437,27 +437,27 @@ SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *setti
                 {
                     scope = new Scope(this, tok, scope, Scope::eWhile, tok->next()->link()->next());
                     tok = tok->next()->link()->next();
-                    scopeList.push_back(scope);
+                    addScope(scope);
                 }
                 else if (Token::simpleMatch(tok, "do {"))
                 {
                     scope = new Scope(this, tok, scope, Scope::eDo, tok->next());
                     tok = tok->next();
-                    scopeList.push_back(scope);
+                    addScope(scope);
                 }
                 else if (Token::simpleMatch(tok, "switch (") &&
                          Token::simpleMatch(tok->next()->link(), ") {"))
                 {
                     scope = new Scope(this, tok, scope, Scope::eSwitch, tok->next()->link()->next());
                     tok = tok->next()->link()->next();
-                    scopeList.push_back(scope);
+                    addScope(scope);
                 }
                 else if (tok->str() == "{")
                 {
                     if (!Token::Match(tok->previous(), "=|,|{"))
                     {
                         scope = new Scope(this, tok, scope, Scope::eUnconditional, tok);
-                        scopeList.push_back(scope);
+                        addScope(scope);
                     }
                     else
                     {
@@ -482,9 +482,9 @@ SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *setti
         // finish filling in base class info
         for (unsigned int i = 0; i < scope->derivedFrom.size(); ++i)
         {
-            std::list<Scope *>::iterator it1;
+            const std::vector<Scope *> &candidates = _scopesByName[scope->derivedFrom[i].name];
 
-            for (it1 = scopeList.begin(); it1 != scopeList.end(); ++it1)
+            for (std::vector<Scope *>::const_iterator it1 = candidates.begin(); it1 != candidates.end(); ++it1)
             {
                 Scope *scope1 = *it1;
 
@@ -653,6 +653,9 @@ SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *setti
         std::list<Function>::const_iterator func;
         for (func = scope->functionList.begin(); func != scope->functionList.end(); ++func)
         {
+            // index the function by its token
+            _functionsByToken.insert(std::make_pair(func->token, &*func));
+
             // ignore function without implementations
             if (!func->hasBody)
                 continue;
@@ -672,6 +675,16 @@ SymbolDatabase::SymbolDatabase(const Tokenizer *tokenizer, const Settings *setti
     }
 }
 
+void SymbolDatabase::addScope(Scope *scope)
+{
+    scopeList.push_back(scope);
+
+    _scopesByName[scope->className].push_back(scope);
+    _scopeOrder.insert(std::make_pair(scope, (unsigned int)_scopeOrder.size()));
+    if (scope->type == Scope::eFunction)
+        _functionScopesByToken.insert(std::make_pair(scope->classDef, scope));
+}
+
 SymbolDatabase::~SymbolDatabase()
 {
     std::list<Scope *>::iterator it;
@@ -826,15 +839,20 @@ void SymbolDatabase::addFunction(Scope **scope, const Token **tok, const Token *
         path_length++;
     }
 
-    std::list<Scope *>::iterator it1;
+    // search for match. Only scopes named like tok1 can match so walk
+    // those, in scopeList order. Scopes added while searching are
+    // appended to the vector and are visited too.
+    std::string name(tok1->str());
+    std::vector<Scope *> *candidates = &_scopesByName[name];
 
-    // search for match
-    for (it1 = scopeList.begin(); it1 != scopeList.end(); ++it1)
+    unsigned int i = 0;
+    while (i < candidates->size())
     {
-        Scope *scope1 = *it1;
+        Scope *scope1 = (*candidates)[i];
+        unsigned int next = i + 1;
 
         bool match = false;
-        if (scope1->className == tok1->str() && (scope1->type != Scope::eFunction))
+        if (scope1->type != Scope::eFunction)
         {
             // do the spaces match (same space) or do their names match (multiple namespaces)
             if ((*scope == scope1->nestedIn) || (*scope && scope1 &&
@@ -859,6 +877,18 @@ void SymbolDatabase::addFunction(Scope **scope, const Token **tok, const Token *
             }
         }
 
+        // the path was followed so continue with the scopes named like
+        // the new tok1 that come after this one in scopeList
+        if (tok1->str() != name)
+        {
+            const unsigned int order = _scopeOrder[(*candidates)[i]];
+            name = tok1->str();
+            candidates = &_scopesByName[name];
+            next = 0;
+            while (next < candidates->size() && _scopeOrder[(*candidates)[next]] <= order)
+                ++next;
+        }
+
         if (match)
         {
             std::list<Function>::iterator func;
@@ -930,6 +960,8 @@ void SymbolDatabase::addFunction(Scope **scope, const Token **tok, const Token *
                 }
             }
         }
+
+        i = next;
     }
 
     // check for class function for unknown class
@@ -966,7 +998,7 @@ void SymbolDatabase::addNewFunction(Scope **scope, const Token **tok)
         *scope = new_scope;
 
         // add space
-        scopeList.push_back(new_scope);
+        addScope(new_scope);
 
         *tok = tok1;
     }
@@ -1587,9 +1619,13 @@ bool Scope::findClosingBracket(const Token* tok, const Token*& close) const
 
 const Scope *SymbolDatabase::findVariableType(const Scope *start, const Token *type) const
 {
-    std::list<Scope *>::const_iterator it;
+    std::map<std::string, std::vector<Scope *> >::const_iterator candidates = _scopesByName.find(type->str());
+    if (candidates == _scopesByName.end())
+        return NULL;
 
-    for (it = scopeList.begin(); it != scopeList.end(); ++it)
+    std::vector<Scope *>::const_iterator it;
+
+    for (it = candidates->second.begin(); it != candidates->second.end(); ++it)
     {
         const Scope *scope = *it;
 
@@ -1597,28 +1633,24 @@ const Scope *SymbolDatabase::findVariableType(const Scope *start, const Token *t
         if (scope->type == Scope::eNamespace || scope->type == Scope::eFunction || scope->type == Scope::eGlobal)
             continue;
 
-        // do the names match?
-        if (scope->className == type->str())
+        // check if type does not have a namespace
+        if (type->previous()->str() != "::")
         {
-            // check if type does not have a namespace
-            if (type->previous()->str() != "::")
-            {
-                const Scope *parent = start;
+            const Scope *parent = start;
 
-                // check if in same namespace
-                while (parent && parent != scope->nestedIn)
-                    parent = parent->nestedIn;
+            // check if in same namespace
+            while (parent && parent != scope->nestedIn)
+                parent = parent->nestedIn;
 
-                if (scope->nestedIn == parent)
-                    return scope;
-            }
-
-            // type has a namespace
-            else
-            {
-                // FIXME check if namespace path matches supplied path
+            if (scope->nestedIn == parent)
                 return scope;
-            }
+        }
+
+        // type has a namespace
+        else
+        {
+            // FIXME check if namespace path matches supplied path
+            return scope;
         }
     }
 
@@ -1629,34 +1661,36 @@ const Scope *SymbolDatabase::findVariableType(const Scope *start, const Token *t
 
 const Scope *SymbolDatabase::findFunctionScopeByToken(const Token *tok) const
 {
-    std::list<Scope *>::const_iterator scope;
-
-    for (scope = scopeList.begin(); scope != scopeList.end(); ++scope)
-    {
-        if ((*scope)->type == Scope::eFunction)
-        {
-            if ((*scope)->classDef == tok)
-                return (*scope);
-        }
-    }
-    return 0;
+    std::map<const Token *, const Scope *>::const_iterator it = _functionScopesByToken.find(tok);
+    if (it == _functionScopesByToken.end())
+        return 0;
+    return it->second;
 }
 
 //---------------------------------------------------------------------------
 
 const Function *SymbolDatabase::findFunctionByToken(const Token *tok) const
 {
-    std::list<Scope *>::const_iterator scope;
+    std::map<const Token *, const Function *>::const_iterator it = _functionsByToken.find(tok);
+    if (it == _functionsByToken.end())
+        return 0;
+    return it->second;
+}
 
-    for (scope = scopeList.begin(); scope != scopeList.end(); ++scope)
-    {
-        std::list<Function>::const_iterator func;
+//---------------------------------------------------------------------------
 
-        for (func = (*scope)->functionList.begin(); func != (*scope)->functionList.end(); ++func)
-        {
-            if (func->token == tok)
-                return &*func;
-        }
+const Scope *SymbolDatabase::findFunctionScopeByName(const std::string &name) const
+{
+    std::map<std::string, std::vector<Scope *> >::const_iterator candidates = _scopesByName.find(name);
+    if (candidates == _scopesByName.end())
+        return 0;
+
+    std::vector<Scope *>::const_iterator it;
+
+    for (it = candidates->second.begin(); it != candidates->second.end(); ++it)
+    {
+        if ((*it)->type == Scope::eFunction)
+            return *it;
     }
     return 0;
 }
@@ -1665,11 +1699,16 @@ const Function *SymbolDatabase::findFunctionByToken(const Token *tok) const
 
 Scope * Scope::findInNestedList(const std::string & name)
 {
-    std::list<Scope *>::iterator it;
+    // the nested scopes are in scopeList in the same order as in nestedList
+    std::map<std::string, std::vector<Scope *> >::const_iterator candidates = check->_scopesByName.find(name);
+    if (candidates == check->_scopesByName.end())
+        return 0;
 
-    for (it = nestedList.begin(); it != nestedList.end(); ++it)
+    std::vector<Scope *>::const_iterator it;
+
+    for (it = candidates->second.begin(); it != candidates->second.end(); ++it)
     {
-        if ((*it)->className == name)
+        if ((*it)->nestedIn == this)
             return (*it);
     }
     return 0;
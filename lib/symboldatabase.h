@@ -25,6 +25,7 @@
 #include <list>
 #include <vector>
 #include <set>
+#include <map>
 
 #include "token.h"
 
@@ -496,6 +497,13 @@ public:
 
     const Function *findFunctionByToken(const Token *tok) const;
 
+    /**
+     * @brief find the first function scope with a given name
+     * @param name function name
+     * @return pointer to function scope if found or NULL if not found
+     */
+    const Scope *findFunctionScopeByName(const std::string &name) const;
+
     bool argsMatch(const Scope *info, const Token *first, const Token *second, const std::string &path, unsigned int depth) const;
 
     bool isClassOrStruct(const std::string &type) const
@@ -513,6 +521,12 @@ public:
      */
     void debugMessage(const Token *tok, const std::string &msg) const;
 
+    /** @brief Version of the token list the database was built for, see Tokenizer::tokensVersion() */
+    unsigned int tokensVersion() const
+    {
+        return _tokensVersion;
+    }
+
 private:
 
     // Needed by Borland C++:
@@ -523,13 +537,31 @@ private:
     const Token *initBaseInfo(Scope *info, const Token *tok);
     bool isFunction(const Token *tok, const Token **funcStart, const Token **argStart) const;
 
+    /** @brief add scope to scopeList and to the lookup indexes */
+    void addScope(Scope *scope);
+
     /** class/struct types */
     std::set<std::string> classAndStructTypes;
 
+    /** scopes for each scope name, in scopeList order */
+    std::map<std::string, std::vector<Scope *> > _scopesByName;
+
+    /** position of each scope in scopeList */
+    std::map<const Scope *, unsigned int> _scopeOrder;
+
+    /** first function scope for each classDef token */
+    std::map<const Token *, const Scope *> _functionScopesByToken;
+
+    /** first function for each function token */
+    std::map<const Token *, const Function *> _functionsByToken;
+
     const Tokenizer *_tokenizer;
     const Settings *_settings;
     ErrorLogger *_errorLogger;
 
+    /** version of the token list the database was built for */
+    const unsigned int _tokensVersion;
+
     /** variable symbol table */
     std::vector<const Variable *> _variableList;
 };
@@ -0,0 +1,206 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "threading.h"
+#include "token.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <time.h>
+#include <errno.h>
+#endif
+
+#include <cassert>
+
+Mutex::Mutex()
+{
+#ifdef _WIN32
+    CRITICAL_SECTION *section = new CRITICAL_SECTION;
+    InitializeCriticalSection(section);
+    _mutex = section;
+#else
+    pthread_mutex_t *mutex = new pthread_mutex_t;
+    pthread_mutex_init(mutex, NULL);
+    _mutex = mutex;
+#endif
+}
+
+Mutex::~Mutex()
+{
+#ifdef _WIN32
+    DeleteCriticalSection(static_cast<CRITICAL_SECTION *>(_mutex));
+    delete static_cast<CRITICAL_SECTION *>(_mutex);
+#else
+    pthread_mutex_destroy(static_cast<pthread_mutex_t *>(_mutex));
+    delete static_cast<pthread_mutex_t *>(_mutex);
+#endif
+}
+
+void Mutex::lock()
+{
+#ifdef _WIN32
+    EnterCriticalSection(static_cast<CRITICAL_SECTION *>(_mutex));
+#else
+    pthread_mutex_lock(static_cast<pthread_mutex_t *>(_mutex));
+#endif
+}
+
+void Mutex::unlock()
+{
+#ifdef _WIN32
+    LeaveCriticalSection(static_cast<CRITICAL_SECTION *>(_mutex));
+#else
+    pthread_mutex_unlock(static_cast<pthread_mutex_t *>(_mutex));
+#endif
+}
+
+Mutex outputMutex;
+
+//---------------------------------------------------------------------------
+
+#ifdef _WIN32
+static unsigned int __stdcall threadProc(void *thread)
+#else
+extern "C" void *threadProc(void *thread)
+#endif
+{
+    Thread::run(static_cast<Thread *>(thread));
+    return 0;
+}
+
+Thread::Thread()
+    : _handle(0), _function(0), _arg(0)
+{
+}
+
+Thread::~Thread()
+{
+    join();
+}
+
+bool Thread::start(Function function, void *arg)
+{
+    assert(_handle == 0);
+
+    _function = function;
+    _arg = arg;
+
+#ifdef _WIN32
+    const uintptr_t handle = _beginthreadex(NULL, 0, threadProc, this, 0, NULL);
+    if (handle == 0)
+        return false;
+    _handle = reinterpret_cast<void *>(handle);
+#else
+    pthread_t *handle = new pthread_t;
+    if (pthread_create(handle, NULL, threadProc, this) != 0)
+    {
+        delete handle;
+        return false;
+    }
+    _handle = handle;
+#endif
+    return true;
+}
+
+void Thread::join()
+{
+    if (!_handle)
+        return;
+
+#ifdef _WIN32
+    WaitForSingleObject(static_cast<HANDLE>(_handle), INFINITE);
+    CloseHandle(static_cast<HANDLE>(_handle));
+#else
+    pthread_join(*static_cast<pthread_t *>(_handle), NULL);
+    delete static_cast<pthread_t *>(_handle);
+#endif
+    _handle = 0;
+}
+
+void Thread::run(Thread *thread)
+{
+    thread->_function(thread->_arg);
+
+    // The thread is about to exit
+    Token::clearMatchCache();
+    Token::releaseMemory();
+}
+
+long Thread::fetchAndIncrement(volatile long &value)
+{
+    return fetchAndAdd(value, 1);
+}
+
+long Thread::fetchAndAdd(volatile long &value, long addend)
+{
+#if defined(_WIN32)
+    return InterlockedExchangeAdd(&value, addend);
+#elif defined(__GNUC__)
+    return __sync_fetch_and_add(&value, addend);
+#else
+    static Mutex mutex;
+    Mutex::Lock lock(mutex);
+    const long old = value;
+    value += addend;
+    return old;
+#endif
+}
+
+void Thread::sleep(unsigned int milliseconds)
+{
+#ifdef _WIN32
+    Sleep(milliseconds);
+#else
+    struct timespec duration;
+    duration.tv_sec = milliseconds / 1000;
+    duration.tv_nsec = (milliseconds % 1000) * 1000000L;
+    // Continue sleeping if a signal interrupts the sleep
+    while (nanosleep(&duration, &duration) != 0 && errno == EINTR)
+        ;
+#endif
+}
+
+//---------------------------------------------------------------------------
+
+Mutex JobSlots::_mutex;
+unsigned int JobSlots::_free = 0;
+
+void JobSlots::release(unsigned int count)
+{
+    Mutex::Lock lock(_mutex);
+    _free += count;
+}
+
+bool JobSlots::acquire()
+{
+    Mutex::Lock lock(_mutex);
+    if (_free == 0)
+        return false;
+    --_free;
+    return true;
+}
+
+void JobSlots::remove(unsigned int count)
+{
+    Mutex::Lock lock(_mutex);
+    assert(_free >= count);
+    _free -= count;
+}
@@ -0,0 +1,164 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef threadingH
+#define threadingH
+
+/** @brief Declare a variable that each thread has its own copy of */
+#ifdef _MSC_VER
+#define THREAD_LOCAL __declspec(thread)
+#else
+#define THREAD_LOCAL __thread
+#endif
+
+/// @addtogroup Core
+/// @{
+
+/**
+ * @brief Mutual exclusion. Uses a critical section on Windows and
+ * a pthread mutex on other platforms.
+ */
+class Mutex
+{
+public:
+    Mutex();
+    ~Mutex();
+
+    void lock();
+    void unlock();
+
+    /** @brief Holds the lock of a mutex during its lifetime */
+    class Lock
+    {
+    public:
+        explicit Lock(Mutex &mutex) : _mutex(mutex)
+        {
+            _mutex.lock();
+        }
+
+        ~Lock()
+        {
+            _mutex.unlock();
+        }
+
+    private:
+        Mutex &_mutex;
+
+        // Not implemented..
+        Lock(const Lock &);
+        void operator=(const Lock &);
+    };
+
+private:
+    /** @brief platform specific mutex */
+    void *_mutex;
+
+    // Not implemented..
+    Mutex(const Mutex &);
+    void operator=(const Mutex &);
+};
+
+/**
+ * @brief Serializes the output to std::cout and std::cerr, so that the
+ * lines that different threads write are not mixed.
+ */
+extern Mutex outputMutex;
+
+/**
+ * @brief A thread that runs a function. The destructor waits for
+ * the function to return.
+ */
+class Thread
+{
+public:
+    typedef void (*Function)(void *arg);
+
+    Thread();
+    ~Thread();
+
+    /**
+     * @brief Start running function(arg) in the thread
+     * @return false if the thread could not be created
+     */
+    bool start(Function function, void *arg);
+
+    /** @brief Wait until the function returns */
+    void join();
+
+    /**
+     * @brief Atomically increment value
+     * @return the value before it was incremented
+     */
+    static long fetchAndIncrement(volatile long &value);
+
+    /**
+     * @brief Atomically add to value. Add 0 to read it atomically.
+     * @return the value before it was changed
+     */
+    static long fetchAndAdd(volatile long &value, long addend);
+
+    /** @brief Suspend the calling thread */
+    static void sleep(unsigned int milliseconds);
+
+    /** @brief Entry point of the created thread */
+    static void run(Thread *thread);
+
+private:
+    /** @brief platform specific thread handle, 0 if not running */
+    void *_handle;
+
+    Function _function;
+    void *_arg;
+
+    // Not implemented..
+    Thread(const Thread &);
+    void operator=(const Thread &);
+};
+
+/**
+ * @brief Spare threads for -j. ThreadExecutor adds a slot when it has
+ * fewer files than jobs and when one of its workers has no more files
+ * to check. CppCheck uses free slots to check several configurations of
+ * a file at the same time.
+ */
+class JobSlots
+{
+public:
+    /** @brief Add slots that may be used */
+    static void release(unsigned int count);
+
+    /**
+     * @brief Take a free slot. Call release(1) when it isn't used anymore.
+     * @return true if a slot was taken
+     */
+    static bool acquire();
+
+    /**
+     * @brief Remove slots that were added with release(). The slots
+     * must be free.
+     */
+    static void remove(unsigned int count);
+
+private:
+    static Mutex _mutex;
+    static unsigned int _free;
+};
+
+/// @}
+
+#endif
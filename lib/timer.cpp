@@ -15,48 +15,186 @@
  * You should have received a copy of the GNU General Public License
  * along with this program.  If not, see <http://www.gnu.org/licenses/>.
  */
-#include <iostream>
 #include "timer.h"
 
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include <vector>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <time.h>
+#include <sys/time.h>
+#endif
+
 /*
 	TODO:
-	- handle SHOWTIME_TOP5 in TimerResults
-	- sort list by time
-	- do not sort the results alphabetically
 	- rename "file" to "single"
-	- synchronise map access in multithreaded mode or disable timing
-	- add unit tests
-		- for --showtime (needs input file)
-		- for Timer* classes
 */
 
+/** @brief The innermost running timer of the calling thread */
+static THREAD_LOCAL Timer *currentTimer = 0;
+
+/** @brief Monotonic wall clock time in nanoseconds */
+static unsigned long long now()
+{
+#if defined(_WIN32)
+    LARGE_INTEGER frequency, counter;
+    QueryPerformanceFrequency(&frequency);
+    QueryPerformanceCounter(&counter);
+    const unsigned long long f = static_cast<unsigned long long>(frequency.QuadPart);
+    const unsigned long long c = static_cast<unsigned long long>(counter.QuadPart);
+    return c / f * 1000000000ULL + c % f * 1000000000ULL / f;
+#elif defined(CLOCK_MONOTONIC)
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return static_cast<unsigned long long>(ts.tv_sec) * 1000000000ULL + static_cast<unsigned long long>(ts.tv_nsec);
+#else
+    timeval tv;
+    gettimeofday(&tv, 0);
+    return static_cast<unsigned long long>(tv.tv_sec) * 1000000000ULL + static_cast<unsigned long long>(tv.tv_usec) * 1000ULL;
+#endif
+}
 
-void TimerResults::ShowResults()
+static double seconds(unsigned long long nanoseconds)
 {
-    std::clock_t overallClocks = 0;
+    return static_cast<double>(nanoseconds) / 1000000000.0;
+}
 
-    std::map<std::string, struct TimerResultsData>::const_iterator I = _results.begin();
-    const std::map<std::string, struct TimerResultsData>::const_iterator E = _results.end();
+typedef std::pair<std::string, TimerResultsData> TimerResult;
 
-    while (I != E)
+static bool moreTime(const TimerResult &r1, const TimerResult &r2)
+{
+    return r1.second._nanoseconds > r2.second._nanoseconds;
+}
+
+static bool moreSelfTime(const TimerResult &r1, const TimerResult &r2)
+{
+    return r1.second.selfNanoseconds() > r2.second.selfNanoseconds();
+}
+
+static std::string jsonString(const std::string &str)
+{
+    std::string ret("\"");
+    for (std::string::size_type i = 0; i < str.length(); ++i)
     {
-        const double sec = (double)I->second._clocks / CLOCKS_PER_SEC;
-        const double secAverage = (double)(I->second._clocks / I->second._numberOfResults) / CLOCKS_PER_SEC;
-        std::cout << I->first << ": " << sec << "s (avg. " << secAverage << "s - " << I->second._numberOfResults  << " result(s))" << std::endl;
+        if (str[i] == '\"' || str[i] == '\\')
+            ret += '\\';
+        ret += str[i];
+    }
+    return ret + "\"";
+}
 
-        overallClocks += I->second._clocks;
+void TimerResults::ShowResults(unsigned int showtimeMode) const
+{
+    std::vector<TimerResult> results;
+    {
+        Mutex::Lock lock(_mutex);
+        results.assign(_results.begin(), _results.end());
+    }
+
+    // Timers that are not nested in other timers make up the overall time
+    unsigned long long overall = 0;
+    for (std::vector<TimerResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+    {
+        if (it->first.find(" > ") == std::string::npos)
+            overall += it->second._nanoseconds;
+    }
+
+    if (showtimeMode == SHOWTIME_JSON)
+    {
+        std::stable_sort(results.begin(), results.end(), moreTime);
+        std::cout << "{\"overall_ns\": " << overall << ", \"timers\": [";
+        for (std::vector<TimerResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+        {
+            std::cout << (it == results.begin() ? "\n" : ",\n")
+                      << "  {\"name\": " << jsonString(it->first)
+                      << ", \"total_ns\": " << it->second._nanoseconds
+                      << ", \"self_ns\": " << it->second.selfNanoseconds()
+                      << ", \"count\": " << it->second._numberOfResults << "}";
+        }
+        std::cout << "\n]}" << std::endl;
+        return;
+    }
 
-        ++I;
+    if (showtimeMode == SHOWTIME_TOP5)
+    {
+        std::stable_sort(results.begin(), results.end(), moreSelfTime);
+        if (results.size() > 5)
+            results.resize(5);
+        for (std::vector<TimerResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+        {
+            std::cout << it->first << ": " << seconds(it->second.selfNanoseconds()) << "s self ("
+                      << seconds(it->second._nanoseconds) << "s total - "
+                      << it->second._numberOfResults << " result(s))" << std::endl;
+        }
     }
+    else
+    {
+        std::stable_sort(results.begin(), results.end(), moreTime);
+        for (std::vector<TimerResult>::const_iterator it = results.begin(); it != results.end(); ++it)
+        {
+            const double sec = seconds(it->second._nanoseconds);
+            const double secAverage = seconds(it->second._nanoseconds / it->second._numberOfResults);
+            std::cout << it->first << ": " << sec << "s (avg. " << secAverage << "s - " << it->second._numberOfResults  << " result(s))" << std::endl;
+        }
+    }
+
+    std::cout << "Overall time: " << seconds(overall) << "s" << std::endl;
+}
 
-    const double secOverall = (double)overallClocks / CLOCKS_PER_SEC;
-    std::cout << "Overall time: " << secOverall << "s" << std::endl;
+void TimerResults::AddResults(const std::string& str, unsigned long long nanoseconds, unsigned long long childNanoseconds)
+{
+    Mutex::Lock lock(_mutex);
+    TimerResultsData &data = _results[str];
+    data._nanoseconds += nanoseconds;
+    data._childNanoseconds += childNanoseconds;
+    data._numberOfResults++;
 }
 
-void TimerResults::AddResults(const std::string& str, std::clock_t clocks)
+void TimerResults::clear()
 {
-    _results[str]._clocks += clocks;
-    _results[str]._numberOfResults++;
+    Mutex::Lock lock(_mutex);
+    _results.clear();
+}
+
+std::string TimerResults::serialize() const
+{
+    Mutex::Lock lock(_mutex);
+    std::ostringstream ostr;
+    for (std::map<std::string, struct TimerResultsData>::const_iterator it = _results.begin(); it != _results.end(); ++it)
+    {
+        ostr << it->second._nanoseconds << ' '
+             << it->second._childNanoseconds << ' '
+             << it->second._numberOfResults << ' '
+             << it->first << '\n';
+    }
+    return ostr.str();
+}
+
+void TimerResults::merge(const std::string &data)
+{
+    std::istringstream istr(data);
+    std::string line;
+    while (std::getline(istr, line))
+    {
+        std::istringstream linestr(line);
+        TimerResultsData result;
+        std::string name;
+        if (!(linestr >> result._nanoseconds >> result._childNanoseconds >> result._numberOfResults))
+            continue;
+        linestr.get();
+        if (!std::getline(linestr, name))
+            continue;
+
+        Mutex::Lock lock(_mutex);
+        TimerResultsData &data2 = _results[name];
+        data2._nanoseconds += result._nanoseconds;
+        data2._childNanoseconds += result._childNanoseconds;
+        data2._numberOfResults += result._numberOfResults;
+    }
 }
 
 Timer::Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf* timerResults)
@@ -65,9 +203,26 @@ Timer::Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf
     , _start(0)
     , _stopped(false)
     , _timerResults(timerResults)
+    , _parent(0)
+    , _addToParent(false)
+    , _childNanoseconds(0)
 {
     if (showtimeMode != SHOWTIME_NONE)
-        _start = std::clock();
+        start(currentTimer);
+}
+
+Timer::Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf* timerResults, const Timer *parent)
+    : _str(str)
+    , _showtimeMode(showtimeMode)
+    , _start(0)
+    , _stopped(false)
+    , _timerResults(timerResults)
+    , _parent(0)
+    , _addToParent(false)
+    , _childNanoseconds(0)
+{
+    if (showtimeMode != SHOWTIME_NONE)
+        start(parent);
 }
 
 Timer::~Timer()
@@ -75,22 +230,56 @@ Timer::~Timer()
     Stop();
 }
 
+const Timer *Timer::current()
+{
+    return currentTimer;
+}
+
+void Timer::start(const Timer *parent)
+{
+    if (parent)
+    {
+        _path = parent->_path + " > " + _str;
+        if (!_timerResults)
+            _timerResults = parent->_timerResults;
+    }
+    else
+    {
+        _path = _str;
+    }
+
+    _parent = currentTimer;
+    _addToParent = bool(parent && parent == currentTimer);
+    currentTimer = this;
+
+    _start = now();
+}
+
 void Timer::Stop()
 {
     if ((_showtimeMode != SHOWTIME_NONE) && !_stopped)
     {
-        const std::clock_t end = std::clock();
-        const std::clock_t diff = end - _start;
+        const unsigned long long diff = now() - _start;
+
+        if (_addToParent)
+            _parent->_childNanoseconds += diff;
+
+        if (currentTimer == this)
+        {
+            currentTimer = _parent;
+            while (currentTimer && currentTimer->_stopped)
+                currentTimer = currentTimer->_parent;
+        }
 
         if (_showtimeMode == SHOWTIME_FILE)
         {
-            double sec = (double)diff / CLOCKS_PER_SEC;
-            std::cout << _str << ": " << sec << "s" << std::endl;
+            Mutex::Lock lock(outputMutex);
+            std::cout << _path << ": " << seconds(diff) << "s" << std::endl;
         }
         else
         {
             if (_timerResults)
-                _timerResults->AddResults(_str, diff);
+                _timerResults->AddResults(_path, diff, _childNanoseconds);
         }
     }
 
@@ -19,16 +19,18 @@
 #ifndef TIMER_H
 #define TIMER_H
 
+#include "threading.h"
+
 #include <string>
 #include <map>
-#include <ctime>
 
 enum
 {
     SHOWTIME_NONE = 0,
     SHOWTIME_FILE,
     SHOWTIME_SUMMARY,
-    SHOWTIME_TOP5
+    SHOWTIME_TOP5,
+    SHOWTIME_JSON
 };
 
 class TimerResultsIntf
@@ -36,21 +38,40 @@ class TimerResultsIntf
 public:
     virtual ~TimerResultsIntf() { }
 
-    virtual void AddResults(const std::string& str, std::clock_t clocks) = 0;
+    /**
+     * @brief Add the time of a timer
+     * @param str name of the timer. The names of the timers that it is
+     * nested in come first, e.g. "CppCheck::check > Tokenizer::tokenize"
+     * @param nanoseconds wall clock time of the timer
+     * @param childNanoseconds time of the timers nested in it
+     */
+    virtual void AddResults(const std::string& str, unsigned long long nanoseconds, unsigned long long childNanoseconds) = 0;
 };
 
 struct TimerResultsData
 {
-    std::clock_t _clocks;
+    unsigned long long _nanoseconds;
+    unsigned long long _childNanoseconds;
     long _numberOfResults;
 
     TimerResultsData()
-        : _clocks(0)
+        : _nanoseconds(0)
+        , _childNanoseconds(0)
         , _numberOfResults(0)
     {
     }
+
+    /** @brief time of the timer itself, without nested timers */
+    unsigned long long selfNanoseconds() const
+    {
+        return _nanoseconds > _childNanoseconds ? _nanoseconds - _childNanoseconds : 0;
+    }
 };
 
+/**
+ * @brief Collects the time of the timers. Timers in several threads can
+ * add their results at the same time.
+ */
 class TimerResults : public TimerResultsIntf
 {
 public:
@@ -58,28 +79,82 @@ public:
     {
     }
 
-    void ShowResults();
-    virtual void AddResults(const std::string& str, std::clock_t clocks);
+    /**
+     * @brief Print the results
+     * @param showtimeMode SHOWTIME_SUMMARY: all timers sorted by time,
+     * SHOWTIME_TOP5: the 5 timers that take most time themselves,
+     * SHOWTIME_JSON: all timers in JSON format
+     */
+    void ShowResults(unsigned int showtimeMode = SHOWTIME_SUMMARY) const;
+    virtual void AddResults(const std::string& str, unsigned long long nanoseconds, unsigned long long childNanoseconds);
+
+    /** @brief Remove all results */
+    void clear();
+
+    /** @brief Results as text, see merge() */
+    std::string serialize() const;
+
+    /** @brief Add results that another process has serialized */
+    void merge(const std::string &data);
 
 private:
+    mutable Mutex _mutex;
     std::map<std::string, struct TimerResultsData> _results;
 };
 
+/**
+ * @brief Measures the wall clock time of a scope. Timers that are started
+ * while another timer of the same thread is running are nested in it.
+ */
 class Timer
 {
 public:
+    /**
+     * @brief Start the timer
+     * @param str name of the timer
+     * @param showtimeMode SHOWTIME_NONE: do nothing, SHOWTIME_FILE: print
+     * the time when the timer stops, else: add the time to timerResults
+     * @param timerResults where the time is added. If it is NULL the time
+     * is added where the time of the parent timer is added.
+     */
     Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf* timerResults = NULL);
+
+    /**
+     * @brief Start a timer that is nested in a timer of another thread.
+     * The time is not added to the time of the parent.
+     */
+    Timer(const std::string& str, unsigned int showtimeMode, TimerResultsIntf* timerResults, const Timer *parent);
+
     ~Timer();
     void Stop();
 
+    /** @brief The innermost running timer of the calling thread, NULL if there is none */
+    static const Timer *current();
+
 private:
+    Timer(const Timer &); // disallow copying
     Timer& operator=(const Timer&); // disallow assignments
 
+    void start(const Timer *parent);
+
     const std::string _str;
+
+    /** @brief The names of the parent timers and this timer */
+    std::string _path;
+
     const unsigned int _showtimeMode;
-    std::clock_t _start;
+    unsigned long long _start;
     bool _stopped;
     TimerResultsIntf* _timerResults;
+
+    /** @brief The timer that was running in this thread when this timer started */
+    Timer *_parent;
+
+    /** @brief Is the time added to the time of the nested timers of _parent? */
+    bool _addToParent;
+
+    /** @brief The time of the timers nested in this timer */
+    unsigned long long _childNanoseconds;
 };
 
 
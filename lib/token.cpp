@@ -19,6 +19,8 @@
 #include "token.h"
 #include "errorlogger.h"
 #include "check.h"
+#include "threading.h"
+#include <algorithm>
 #include <cassert>
 #include <cstdlib>
 #include <cstring>
@@ -27,10 +29,428 @@
 #include <cctype>
 #include <sstream>
 #include <map>
+#include <vector>
 
-Token::Token(Token **t) :
+/**
+ * @brief Stored before each token: the pool that the token was taken
+ * from, or 0 if it was allocated from the heap.
+ */
+struct TokenHeader
+{
+    TokenPool *pool;
+};
+
+/** @brief Memory for a token in the blocks of a TokenPool */
+static const std::size_t tokenSlotSize = sizeof(TokenHeader) + sizeof(Token);
+
+/** @brief Number of tokens in each block of a TokenPool */
+enum { TokensPerBlock = 1024 };
+
+TokenPool::TokenPool() : _free(0), _used(0)
+{
+}
+
+TokenPool::~TokenPool()
+{
+    // Tokens that are not deleted would point at freed memory
+    if (_used != 0)
+    {
+        std::cerr << "cppcheck: internal error: " << _used << " tokens were not deleted before their pool" << std::endl;
+        std::abort();
+    }
+
+    for (std::vector<char *>::iterator it = _blocks.begin(); it != _blocks.end(); ++it)
+        ::operator delete(*it);
+}
+
+void *TokenPool::allocate()
+{
+    if (!_free)
+        addBlock();
+    FreeSlot *slot = _free;
+    _free = slot->next;
+    ++_used;
+    return slot;
+}
+
+void TokenPool::deallocate(void *p)
+{
+    FreeSlot *slot = static_cast<FreeSlot *>(p);
+    slot->next = _free;
+    _free = slot;
+    --_used;
+}
+
+void TokenPool::addBlock()
+{
+    char *block = static_cast<char *>(::operator new(TokensPerBlock * tokenSlotSize));
+    _blocks.push_back(block);
+    for (unsigned int i = TokensPerBlock; i > 0; --i)
+    {
+        FreeSlot *slot = reinterpret_cast<FreeSlot *>(block + (i - 1) * tokenSlotSize);
+        slot->next = _free;
+        _free = slot;
+    }
+}
+
+/** @brief C and C++ keywords, sorted */
+static const char * const keywords[] =
+{
+    "asm", "auto", "bool", "break", "case", "catch", "char", "class", "const",
+    "const_cast", "continue", "default", "delete", "do", "double",
+    "dynamic_cast", "else", "enum", "explicit", "export", "extern", "false",
+    "float", "for", "friend", "goto", "if", "inline", "int", "long",
+    "mutable", "namespace", "new", "operator", "private", "protected",
+    "public", "register", "reinterpret_cast", "return", "short", "signed",
+    "sizeof", "static", "static_cast", "struct", "switch", "template",
+    "this", "throw", "true", "try", "typedef", "typeid", "typename", "union",
+    "unsigned", "using", "virtual", "void", "volatile", "wchar_t", "while"
+};
+
+/**
+ * @brief Punctuators, and the empty text of new tokens. They get fixed
+ * string ids like the keywords.
+ */
+static const char * const punctuators[] =
+{
+    "", "(", ")", "[", "]", "{", "}", ";", ",", ".", "::", "->", "?", ":",
+    "#", "...", "=", "+=", "-=", "*=", "/=", "%=", "&=", "|=", "^=", "<<=",
+    ">>=", "==", "!=", "<", "<=", ">", ">=", "+", "-", "*", "/", "%", "<<",
+    ">>", "++", "--", "&&", "||", "!", "&", "|", "^", "~"
+};
+
+static bool lessString(const char *s1, const char *s2)
+{
+    return std::strcmp(s1, s2) < 0;
+}
+
+/** @brief Classify the text of a token, see Token::Kind */
+static unsigned int classify(const std::string &str)
+{
+    if (str.empty())
+        return 0;
+
+    unsigned int kind = 0;
+
+    if (str[0] == '\"')
+        return Token::eString;
+    if (str[0] == '\'')
+        return Token::eChar;
+
+    if (str[0] == '_' || std::isalpha(str[0]))
+    {
+        const char * const *end = keywords + sizeof(keywords) / sizeof(*keywords);
+        if (std::binary_search(keywords, end, str.c_str(), lessString))
+            kind |= Token::eKeyword;
+
+        if (str == "bool" || str == "char" || str == "short" || str == "int" ||
+            str == "long" || str == "float" || str == "double" || str == "size_t")
+            kind |= Token::eStandardType;
+
+        return kind;
+    }
+
+    if (str.length() == 1 && std::strchr("()[]{}", str[0]))
+        return Token::eBracket;
+
+    if (str == "=" || str == "+=" || str == "-=" || str == "*=" || str == "/=" ||
+        str == "%=" || str == "&=" || str == "|=" || str == "^=" ||
+        str == "<<=" || str == ">>=")
+        return Token::eAssignmentOp;
+
+    if (str == "==" || str == "!=" || str == "<" || str == "<=" || str == ">" || str == ">=")
+        return Token::eComparisonOp;
+
+    if (str == "+" || str == "-" || str == "*" || str == "/" || str == "%" ||
+        str == "<<" || str == ">>")
+        return Token::eArithmeticalOp;
+
+    if (str == "&&" || str == "||" || str == "!")
+        return Token::eLogicalOp;
+
+    if (str == "&" || str == "|" || str == "^" || str == "~")
+        return Token::eBitOp;
+
+    return 0;
+}
+
+class StringTable;
+
+/**
+ * @brief A string in the StringTable. The token flags that only depend
+ * on the text are calculated once when the string is added.
+ */
+class TokenString : public std::string
+{
+public:
+    TokenString(const std::string &s, const StringTable *o, unsigned int i)
+        : std::string(s),
+          refs(0),
+          owner(o),
+          id(i),
+          kind(classify(s)),
+          isName(!s.empty() && (s[0] == '_' || std::isalpha(s[0]))),
+          isNumber(!s.empty() && (std::isdigit(s[0]) || (s.length() > 1 && s[0] == '-' && std::isdigit(s[1])))),
+          isBoolean(s == "true" || s == "false")
+    { }
+
+    /**
+     * @brief number of tokens and compiled patterns that use the string.
+     * Changed with Thread::fetchAndAdd(), a token may be deleted by
+     * another thread than the one that created it.
+     */
+    volatile long refs;
+
+    /** @brief the table that created the string, 0 for the fixed strings */
+    const StringTable * const owner;
+
+    /** @brief the id of a fixed string, 0 for the other strings */
+    const unsigned int id;
+
+    /** @brief Token::Kind flags */
+    const unsigned int kind;
+
+    const bool isName;
+    const bool isNumber;
+    const bool isBoolean;
+};
+
+/**
+ * @brief The strings of the keywords and punctuators. They are created
+ * once and never changed, so all threads share them. Their ids are
+ * 1, 2, 3.. and Match() compares them as integers.
+ */
+class FixedStrings
+{
+public:
+    FixedStrings()
+    {
+        add(keywords, sizeof(keywords) / sizeof(*keywords));
+        add(punctuators, sizeof(punctuators) / sizeof(*punctuators));
+    }
+
+    ~FixedStrings()
+    {
+        for (std::vector<TokenString *>::iterator it = _strings.begin(); it != _strings.end(); ++it)
+            delete *it;
+    }
+
+    const std::vector<TokenString *> &strings() const
+    {
+        return _strings;
+    }
+
+private:
+    void add(const char * const texts[], std::size_t count)
+    {
+        for (std::size_t i = 0; i < count; ++i)
+            _strings.push_back(new TokenString(texts[i], 0, static_cast<unsigned int>(_strings.size() + 1)));
+    }
+
+    // Not implemented..
+    FixedStrings(const FixedStrings &);
+    FixedStrings &operator=(const FixedStrings &);
+
+    std::vector<TokenString *> _strings;
+};
+
+static const FixedStrings fixedStrings;
+
+/**
+ * @brief The strings of the tokens of a thread. Tokens with the same
+ * text share one string, so the text of two tokens from the same table
+ * can be compared by address. The table starts with the fixed strings.
+ * Other strings that are no longer used are freed when the table grows.
+ */
+class StringTable
+{
+public:
+    StringTable() : _table(1024), _count(0)
+    {
+        const std::vector<TokenString *> &fixed = fixedStrings.strings();
+        for (std::vector<TokenString *>::const_iterator it = fixed.begin(); it != fixed.end(); ++it)
+            insert(*it);
+    }
+
+    ~StringTable()
+    {
+        for (std::vector<TokenString *>::iterator it = _table.begin(); it != _table.end(); ++it)
+        {
+            if (*it && (*it)->owner == this)
+                delete *it;
+        }
+    }
+
+    /** @brief Get the shared string, release it with release() */
+    const std::string *get(const std::string &str)
+    {
+        if ((_count + 1) * 2 > _table.size())
+            rehash();
+
+        // open addressing with linear probing
+        const std::size_t mask = _table.size() - 1;
+        std::size_t index = hash(str) & mask;
+        while (_table[index])
+        {
+            if (*_table[index] == str)
+                break;
+            index = (index + 1) & mask;
+        }
+
+        if (!_table[index])
+        {
+            _table[index] = new TokenString(str, this, 0);
+            ++_count;
+        }
+
+        TokenString * const tokenString = _table[index];
+        if (tokenString->owner)
+            Thread::fetchAndAdd(tokenString->refs, 1);
+        return tokenString;
+    }
+
+    /** @brief Release a string that get() returned, any thread may do that */
+    static void release(const std::string *str)
+    {
+        TokenString * const tokenString = static_cast<TokenString *>(const_cast<std::string *>(str));
+        if (tokenString->owner)
+            Thread::fetchAndAdd(tokenString->refs, -1);
+    }
+
+    /** @brief Are all strings released? */
+    bool unused() const
+    {
+        for (std::vector<TokenString *>::const_iterator it = _table.begin(); it != _table.end(); ++it)
+        {
+            if (*it && (*it)->owner && Thread::fetchAndAdd((*it)->refs, 0) > 0)
+                return false;
+        }
+        return true;
+    }
+
+private:
+    static std::size_t hash(const std::string &str)
+    {
+        // FNV-1a
+        std::size_t h = 2166136261U;
+        for (std::string::size_type i = 0; i < str.length(); ++i)
+        {
+            h ^= static_cast<unsigned char>(str[i]);
+            h *= 16777619U;
+        }
+        return h;
+    }
+
+    /** @brief Add a string that is not in the table */
+    void insert(TokenString *str)
+    {
+        const std::size_t mask = _table.size() - 1;
+        std::size_t index = hash(*str) & mask;
+        while (_table[index])
+            index = (index + 1) & mask;
+        _table[index] = str;
+        ++_count;
+    }
+
+    /**
+     * @brief Free the strings that are not used and make the table
+     * bigger if it is still too full.
+     */
+    void rehash()
+    {
+        std::vector<TokenString *> old;
+        old.swap(_table);
+
+        _count = 0;
+        for (std::vector<TokenString *>::iterator it = old.begin(); it != old.end(); ++it)
+        {
+            if (!*it)
+                continue;
+            if ((*it)->owner && Thread::fetchAndAdd((*it)->refs, 0) == 0)
+            {
+                delete *it;
+                *it = 0;
+            }
+            else
+                ++_count;
+        }
+
+        std::size_t size = old.size();
+        while (_count * 4 > size)
+            size *= 2;
+        _table.resize(size);
+
+        _count = 0;
+        for (std::vector<TokenString *>::iterator it = old.begin(); it != old.end(); ++it)
+        {
+            if (*it)
+                insert(*it);
+        }
+    }
+
+    // Not implemented..
+    StringTable(const StringTable &);
+    StringTable &operator=(const StringTable &);
+
+    std::vector<TokenString *> _table;
+    std::size_t _count;
+};
+
+/** @brief The token strings of the calling thread */
+static THREAD_LOCAL StringTable *stringTable = 0;
+
+/** @brief Get a shared token string from the table of the calling thread */
+static const std::string *internString(const std::string &str)
+{
+    if (!stringTable)
+        stringTable = new StringTable;
+    return stringTable->get(str);
+}
+
+void *Token::operator new(std::size_t size)
+{
+    TokenHeader *header = static_cast<TokenHeader *>(::operator new(sizeof(TokenHeader) + size));
+    header->pool = 0;
+    return header + 1;
+}
+
+void *Token::operator new(std::size_t size, TokenPool &pool)
+{
+    if (size != sizeof(Token))
+        return operator new(size);
+    TokenHeader *header = static_cast<TokenHeader *>(pool.allocate());
+    header->pool = &pool;
+    return header + 1;
+}
+
+void Token::operator delete(void *p)
+{
+    if (!p)
+        return;
+    TokenHeader *header = static_cast<TokenHeader *>(p) - 1;
+    if (header->pool)
+        header->pool->deallocate(header);
+    else
+        ::operator delete(header);
+}
+
+void Token::operator delete(void *p, TokenPool &)
+{
+    operator delete(p);
+}
+
+void Token::releaseMemory()
+{
+    if (stringTable && stringTable->unused())
+    {
+        delete stringTable;
+        stringTable = 0;
+    }
+}
+
+Token::Token(Token **t, TokenPool *pool) :
     tokensBack(t),
-    _str(""),
+    _str(internString("")),
     _isName(false),
     _isNumber(false),
     _isBoolean(false),
@@ -38,54 +458,58 @@ Token::Token(Token **t) :
     _isSigned(false),
     _isLong(false),
     _isUnused(false),
+    _kind(0),
+    _strId(static_cast<const TokenString *>(_str)->id),
     _varId(0),
     _next(0),
     _previous(0),
     _link(0),
     _fileIndex(0),
     _linenr(0),
-    _progressValue(0)
+    _progressValue(0),
+    _pool(pool)
 {
 }
 
 Token::~Token()
 {
-
+    StringTable::release(_str);
 }
 
 void Token::str(const std::string &s)
 {
-    _str = s;
+    const TokenString *newStr = static_cast<const TokenString *>(internString(s));
+    StringTable::release(_str);
+    _str = newStr;
 
-    _isName = bool(_str[0] == '_' || std::isalpha(_str[0]));
-
-    if (std::isdigit(_str[0]))
-        _isNumber = true;
-    else if (_str.length() > 1 && _str[0] == '-' && std::isdigit(_str[1]))
-        _isNumber = true;
-    else
-        _isNumber = false;
-
-    if (_str == "true" || _str == "false")
-        _isBoolean = true;
-    else
-        _isBoolean = false;
+    _isName = newStr->isName;
+    _isNumber = newStr->isNumber;
+    _isBoolean = newStr->isBoolean;
+    _kind = newStr->kind;
+    _strId = newStr->id;
 
     _varId = 0;
 }
 
 void Token::concatStr(std::string const& b)
 {
-    _str.erase(_str.length() - 1);
-    _str.append(b.begin() + 1, b.end());
+    std::string s(*_str);
+    s.erase(s.length() - 1);
+    s.append(b.begin() + 1, b.end());
+
+    const TokenString *newStr = static_cast<const TokenString *>(internString(s));
+    StringTable::release(_str);
+    _str = newStr;
+    _kind = newStr->kind;
+    _strId = newStr->id;
 }
 
 std::string Token::strValue() const
 {
-    assert(_str.length() >= 2);
-    assert(_str[0] == '"');
-    assert(_str[_str.length()-1] == '"');
-    return _str.substr(1, _str.length() - 2);
+    assert(_str->length() >= 2);
+    assert((*_str)[0] == '"');
+    assert((*_str)[_str->length()-1] == '"');
+    return _str->substr(1, _str->length() - 2);
 }
 
 void Token::deleteNext()
@@ -103,7 +527,7 @@ void Token::deleteThis()
 {
     if (_next)
     {
-        _str = _next->_str;
+        std::swap(_str, _next->_str);
         _isName = _next->_isName;
         _isNumber = _next->_isNumber;
         _isBoolean = _next->_isBoolean;
@@ -111,6 +535,8 @@ void Token::deleteThis()
         _isSigned = _next->_isSigned;
         _isLong = _next->_isLong;
         _isUnused = _next->_isUnused;
+        _kind = _next->_kind;
+        _strId = _next->_strId;
         _varId = _next->_varId;
         _fileIndex = _next->_fileIndex;
         _linenr = _next->_linenr;
@@ -197,7 +623,7 @@ Token *Token::tokAt(int index)
 std::string Token::strAt(int index) const
 {
     const Token *tok = this->tokAt(index);
-    return tok ? tok->_str.c_str() : "";
+    return tok ? tok->_str->c_str() : "";
 }
 
 int Token::multiCompare(const char *haystack, const char *needle)
@@ -280,7 +706,7 @@ bool Token::simpleMatch(const Token *tok, const char pattern[])
     {
         size_t length = static_cast<size_t>(next - current);
 
-        if (!tok || length != tok->_str.length() || strncmp(current, tok->_str.c_str(), length))
+        if (!tok || length != tok->_str->length() || strncmp(current, tok->_str->c_str(), length))
             return false;
 
         current = next;
@@ -296,267 +722,499 @@ bool Token::simpleMatch(const Token *tok, const char pattern[])
     return true;
 }
 
-int Token::firstWordEquals(const char *str, const char *word)
+//---------------------------------------------------------------------------
+
+/**
+ * @brief A Token::Match pattern that has been split into words and
+ * classified once, so matching doesn't need to parse the pattern string.
+ * The words are stored as offsets into a copy of the pattern.
+ */
+class CompiledPattern
 {
-    for (;;)
+public:
+    explicit CompiledPattern(const char pattern[])
     {
-        if (*str != *word)
-        {
-            if (*str == ' ' && *word == 0)
-                return 0;
-            return 1;
-        }
-        else if (*str == 0)
-            break;
+        compile(pattern);
+    }
 
-        ++str;
-        ++word;
+    ~CompiledPattern()
+    {
+        releaseStrings();
     }
 
-    return 0;
+    /** Compile a pattern. Memory of the previous pattern is reused. */
+    void compile(const char pattern[]);
+
+    /** The pattern that was compiled */
+    const std::string &pattern() const
+    {
+        return _pattern;
+    }
+
+    /** Match token list against the compiled pattern, see Token::Match */
+    bool match(const Token *tok, unsigned int varid) const;
+
+private:
+    enum OpCode { LITERAL, VAR, TYPE, ANY, VARID, NUM, BOOL, STR, OR, OROR, CHARSET, MULTI, NOT };
+
+    /**
+     * A word or an alternative of a multi option word: [start, start+length) in _pattern.
+     * The text is also looked up in the string table so that it can be
+     * compared with the text of tokens by id or by address.
+     */
+    struct Text
+    {
+        std::string::size_type start;
+        std::string::size_type length;
+        const TokenString *str;
+
+        /** id of the text, see Token::strId() */
+        unsigned int id;
+    };
+
+    /** One word of the pattern */
+    struct Op
+    {
+        unsigned char code;
+
+        /** opcode to use instead of CHARSET if the token is not 1 character long */
+        unsigned char fallback;
+
+        /** word starts with "!!". It is skipped if there are no tokens left */
+        bool notPrefix;
+
+        /** CHARSET: "]" is one of the characters, e.g. "[[]]" */
+        bool closeBracket;
+
+        /** MULTI: there is an empty alternative, e.g. "const|" */
+        bool emptyAlternative;
+
+        /** The whole word. For NOT the "!!" is not included */
+        Text word;
+
+        /** MULTI: nonempty alternatives are _alternatives[firstAlternative..firstAlternative+alternatives) */
+        unsigned int firstAlternative;
+        unsigned int alternatives;
+    };
+
+    void compileWord(std::string::size_type start, std::string::size_type length);
+
+    /** Look up the text in the string table */
+    void intern(Text &text) const
+    {
+        text.str = static_cast<const TokenString *>(internString(_pattern.substr(text.start, text.length)));
+        text.id = text.str->id;
+    }
+
+    /** Release the strings of the texts */
+    void releaseStrings();
+
+    static bool equals(const Text &text, const Token *tok)
+    {
+        // keywords and punctuators are compared by id
+        if (text.id != 0 || tok->strId() != 0)
+            return text.id == tok->strId();
+
+        // strings of the same table are compared by address, the text
+        // of a token that another thread created must be compared
+        const TokenString &str = static_cast<const TokenString &>(tok->str());
+        if (text.str == &str)
+            return true;
+        return text.str->owner != str.owner && *text.str == str;
+    }
+
+    // Not implemented..
+    CompiledPattern(const CompiledPattern &);
+    CompiledPattern &operator=(const CompiledPattern &);
+
+    std::string _pattern;
+    std::vector<Op> _ops;
+    std::vector<Text> _alternatives;
+};
+
+void CompiledPattern::releaseStrings()
+{
+    for (std::vector<Op>::const_iterator it = _ops.begin(); it != _ops.end(); ++it)
+        StringTable::release(it->word.str);
+    for (std::vector<Text>::const_iterator it = _alternatives.begin(); it != _alternatives.end(); ++it)
+        StringTable::release(it->str);
 }
 
-const char *Token::chrInFirstWord(const char *str, char c)
+void CompiledPattern::compile(const char pattern[])
 {
-    for (;;)
+    releaseStrings();
+    _pattern.assign(pattern);
+    _ops.clear();
+    _alternatives.clear();
+
+    std::string::size_type pos = 0;
+    while (pos < _pattern.length())
     {
-        if (*str == ' ' || *str == 0)
-            return 0;
+        // Skip spaces in pattern..
+        if (_pattern[pos] == ' ')
+        {
+            ++pos;
+            continue;
+        }
 
-        if (*str == c)
-            return str;
+        std::string::size_type end = _pattern.find(' ', pos);
+        if (end == std::string::npos)
+            end = _pattern.length();
 
-        ++str;
+        compileWord(pos, end - pos);
+
+        pos = end;
     }
 }
 
-int Token::firstWordLen(const char *str)
+void CompiledPattern::compileWord(std::string::size_type start, std::string::size_type length)
 {
-    int len = 0;
-    for (;;)
+    const char * const word = _pattern.data() + start;
+    const std::string::size_type end = start + length;
+
+    Op op;
+    op.word.start = start;
+    op.word.length = length;
+    op.closeBracket = false;
+    op.emptyAlternative = false;
+    op.firstAlternative = 0;
+    op.alternatives = 0;
+
+    // "!!" must be followed by something, else it is a plain word
+    op.notPrefix = bool(length >= 2 && word[0] == '!' && word[1] == '!' && (length > 2 || end < _pattern.length()));
+
+    if (word[0] == '%')
     {
-        if (*str == ' ' || *str == 0)
-            break;
+        // TODO: %var% should match only for
+        // variables that have varId != 0, but that needs a lot of
+        // work, before that change can be made.
+        const std::string w(word, length);
+        if (w == "%var%")
+            op.code = VAR;
+        else if (w == "%type%")
+            op.code = TYPE;
+        else if (w == "%any%")
+            op.code = ANY;
+        else if (w == "%varid%")
+            op.code = VARID;
+        else if (w == "%num%")
+            op.code = NUM;
+        else if (w == "%bool%")
+            op.code = BOOL;
+        else if (w == "%str%")
+            op.code = STR;
+        else if (w == "%or%")
+            op.code = OR;
+        else if (w == "%oror%")
+            op.code = OROR;
+        else
+            op.code = LITERAL;
+        op.fallback = op.code;
+        intern(op.word);
+        _ops.push_back(op);
+        return;
+    }
 
-        ++len;
-        ++str;
+    const std::string::size_type bar = _pattern.find('|', start);
+
+    // Parse multi options, such as void|int|char (accept token which is one of these 3)
+    if (bar < end && (word[0] != '|' || length > 2))
+    {
+        op.fallback = MULTI;
+        op.firstAlternative = static_cast<unsigned int>(_alternatives.size());
+        std::string::size_type pos = start;
+        for (;;)
+        {
+            std::string::size_type next = _pattern.find('|', pos);
+            if (next > end)
+                next = end;
+            if (next == pos)
+                op.emptyAlternative = true;
+            else
+            {
+                Text alternative;
+                alternative.start = pos;
+                alternative.length = next - pos;
+                intern(alternative);
+                _alternatives.push_back(alternative);
+                ++op.alternatives;
+            }
+            if (next == end)
+                break;
+            pos = next + 1;
+        }
     }
 
-    return len;
+    // Parse "not" options. Token can be anything except the given one
+    else if (op.notPrefix)
+    {
+        op.fallback = NOT;
+        op.word.start += 2;
+        op.word.length -= 2;
+    }
+
+    else
+    {
+        op.fallback = LITERAL;
+    }
+
+    op.code = op.fallback;
+
+    // [.. => search for a one-character token..
+    const std::string::size_type bracket = _pattern.find(']', start);
+    if (word[0] == '[' && bracket < end)
+    {
+        op.code = CHARSET;
+        op.closeBracket = bool(_pattern.find(']', bracket + 1) < end);
+    }
+
+    intern(op.word);
+    _ops.push_back(op);
 }
 
-bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
+bool CompiledPattern::match(const Token *tok, unsigned int varid) const
 {
-    const char *p = pattern;
     bool firstpattern = true;
-    while (*p)
+    for (std::vector<Op>::const_iterator op = _ops.begin(); op != _ops.end(); ++op)
     {
-        // Skip spaces in pattern..
-        while (*p == ' ')
-            ++p;
-
-        // No token => Success!
-        if (*p == 0)
-            return true;
-
         if (!tok)
         {
             // If we have no tokens, pattern "!!else" should return true
-            if (p[1] == '!' && p[0] == '!' && p[2] != '\0')
-            {
-                while (*p && *p != ' ')
-                    ++p;
+            if (op->notPrefix)
                 continue;
-            }
-            else
-                return false;
+            return false;
         }
 
         // If we are in the first token, we skip all initial !! patterns
-        if (firstpattern && !tok->previous() && tok->next() && p[1] == '!' && p[0] == '!' && p[2] != '\0')
-        {
-            while (*p && *p != ' ')
-                ++p;
+        if (firstpattern && op->notPrefix && !tok->previous() && tok->next())
             continue;
-        }
 
         firstpattern = false;
 
-        // Compare the first character of the string for optimization reasons
-        // before doing more detailed checks.
-        if (p[0] == '%')
-        {
-            // TODO: %var% should match only for
-            // variables that have varId != 0, but that needs a lot of
-            // work, before that change can be made.
-            // Any symbolname..
-            if (firstWordEquals(p, "%var%") == 0)
-            {
-                if (!tok->isName())
-                    return false;
-                p += 5;
-            }
+        const std::string &str = tok->str();
 
-            // Type..
-            else if (firstWordEquals(p, "%type%") == 0)
-            {
-                if (!tok->isName())
-                    return false;
+        unsigned char code = op->code;
+        if (code == CHARSET && str.length() != 1)
+            code = op->fallback;
 
-                if (tok->varId() != 0)
-                    return false;
+        switch (code)
+        {
+        case LITERAL:
+            if (!equals(op->word, tok))
+                return false;
+            break;
 
-                if (tok->str() == "delete")
-                    return false;
+        // Any symbolname..
+        case VAR:
+            if (!tok->isName())
+                return false;
+            break;
 
-                p += 6;
-            }
+        // Type..
+        case TYPE:
+            if (!tok->isName() || tok->varId() != 0 || str == "delete")
+                return false;
+            break;
 
-            // Accept any token
-            else if (firstWordEquals(p, "%any%") == 0)
+        // Accept any token
+        case ANY:
+            break;
+
+        case VARID:
+            if (varid == 0)
             {
-                p += 5;
+                std::list<ErrorLogger::ErrorMessage::FileLocation> locationList;
+                const ErrorLogger::ErrorMessage errmsg(locationList,
+                                                       Severity::error,
+                                                       "Internal error. Token::Match called with varid 0.",
+                                                       "cppcheckError");
+                Check::reportError(errmsg);
             }
 
-            else if (firstWordEquals(p, "%varid%") == 0)
-            {
-                if (varid == 0)
-                {
-                    std::list<ErrorLogger::ErrorMessage::FileLocation> locationList;
-                    const ErrorLogger::ErrorMessage errmsg(locationList,
-                                                           Severity::error,
-                                                           "Internal error. Token::Match called with varid 0.",
-                                                           "cppcheckError");
-                    Check::reportError(errmsg);
-                }
+            if (tok->varId() != varid)
+                return false;
+            break;
 
-                if (tok->varId() != varid)
-                    return false;
+        case NUM:
+            if (!tok->isNumber())
+                return false;
+            break;
 
-                p += 7;
-            }
+        case BOOL:
+            if (!tok->isBoolean())
+                return false;
+            break;
 
-            else if (firstWordEquals(p, "%num%") == 0)
-            {
-                if (!tok->isNumber())
-                    return false;
-                p += 5;
-            }
+        case STR:
+            if (!tok->isString())
+                return false;
+            break;
 
-            else if (firstWordEquals(p, "%bool%") == 0)
-            {
-                if (!tok->isBoolean())
-                    return false;
-                p += 6;
-            }
+        case OR:
+            if (str != "|")
+                return false;
+            break;
 
-            else if (firstWordEquals(p, "%str%") == 0)
-            {
-                if (tok->_str[0] != '\"')
-                    return false;
-                p += 5;
-            }
+        case OROR:
+            if (str != "||")
+                return false;
+            break;
 
-            else if (firstWordEquals(p, "%or%") == 0)
-            {
-                if (tok->str() != "|")
-                    return false;
-                p += 4;
-            }
+        case CHARSET:
+            if (str[0] == ']' ? !op->closeBracket :
+                !std::memchr(_pattern.data() + op->word.start + 1, str[0], op->word.length - 1))
+                return false;
+            break;
 
-            else if (firstWordEquals(p, "%oror%") == 0)
-            {
-                if (tok->str() != "||")
-                    return false;
-                p += 6;
-            }
+        case MULTI:
+        {
+            int res = -1;
 
-            else if (firstWordEquals(p, tok->_str.c_str()))
+            // Tokens such as "|" and "||" need the character based comparison
+            if (str.find('|') != std::string::npos)
             {
-                p += tok->_str.length();
+                res = Token::multiCompare(std::string(_pattern, op->word.start, op->word.length).c_str(), str.c_str());
             }
-
             else
             {
-                return false;
+                for (unsigned int i = 0; i < op->alternatives; ++i)
+                {
+                    if (equals(_alternatives[op->firstAlternative + i], tok))
+                    {
+                        res = 1;
+                        break;
+                    }
+                }
+                if (res == -1 && op->emptyAlternative)
+                    res = 0;
             }
 
-            tok = tok->next();
-            continue;
+            // Empty alternative matches, use the same token on next round
+            if (res == 0)
+                continue;
+
+            // No match
+            if (res == -1)
+                return false;
+            break;
         }
 
-        // [.. => search for a one-character token..
-        else if (p[0] == '[' && tok->_str.length() == 1 && chrInFirstWord(p, ']'))
-        {
-            const char *temp = p + 1;
-            bool chrFound = false;
-            int count = 0;
-            while (*temp && *temp != ' ')
-            {
-                if (*temp == ']')
-                {
-                    ++count;
-                    ++temp;
-                    continue;
-                }
+        case NOT:
+            if (equals(op->word, tok))
+                return false;
+            break;
+        }
 
-                if (*temp == tok->_str[0])
-                {
-                    chrFound = true;
-                    break;
-                }
+        tok = tok->next();
+    }
 
-                ++temp;
-            }
+    // The end of the pattern has been reached and nothing wrong has been found
+    return true;
+}
 
-            if (count > 1)
-            {
-                if (tok->_str[0] == ']')
-                    chrFound = true;
-            }
+/**
+ * @brief Compiled patterns, looked up by the address of the pattern.
+ * Most patterns are string literals so the address identifies them.
+ * Patterns built at runtime may reuse an address, so the text is
+ * compared too and the pattern is recompiled when it has changed.
+ *
+ * The table has 8192 slots, more than the string literals that are
+ * used as patterns. Patterns built at runtime each take a slot, so
+ * all patterns are deleted when half of the slots are used and are
+ * compiled again when they are used. Match() doesn't keep a compiled
+ * pattern after it returns, so no pattern is deleted while it is used.
+ */
+class PatternCache
+{
+public:
+    PatternCache() : _entries(TableSize), _used(0)
+    { }
 
-            if (!chrFound)
-                return false;
-        }
+    ~PatternCache()
+    {
+        clear();
+    }
 
-        // Parse multi options, such as void|int|char (accept token which is one of these 3)
-        else if (chrInFirstWord(p, '|') && (p[0] != '|' || firstWordLen(p) > 2))
+    const CompiledPattern &get(const char pattern[])
+    {
+        // open addressing with linear probing
+        std::size_t index = hash(pattern);
+        while (_entries[index].key)
         {
-            int res = multiCompare(p, tok->_str.c_str());
-            if (res == 0)
-            {
-                // Empty alternative matches, use the same token on next round
-                while (*p && *p != ' ')
-                    ++p;
-                continue;
-            }
-            else if (res == -1)
+            Entry &entry = _entries[index];
+            if (entry.key == pattern)
             {
-                // No match
-                return false;
+                if (std::strcmp(entry.compiled->pattern().c_str(), pattern) != 0)
+                    entry.compiled->compile(pattern);
+                return *entry.compiled;
             }
+            index = (index + 1) & (TableSize - 1);
         }
 
-        // Parse "not" options. Token can be anything except the given one
-        else if (p[1] == '!' && p[0] == '!' && p[2] != '\0')
+        // Patterns built at runtime could make the cache grow without
+        // limit so start over when it gets half full
+        if (_used >= TableSize / 2)
         {
-            if (firstWordEquals(&(p[2]), tok->str().c_str()) == 0)
-                return false;
+            clear();
+            index = hash(pattern);
         }
 
-        else if (firstWordEquals(p, tok->_str.c_str()) != 0)
+        _entries[index].key = pattern;
+        _entries[index].compiled = new CompiledPattern(pattern);
+        ++_used;
+        return *_entries[index].compiled;
+    }
+
+private:
+    static const std::size_t TableSize = 8192;
+
+    struct Entry
+    {
+        Entry() : key(0), compiled(0)
+        { }
+
+        const char *key;
+        CompiledPattern *compiled;
+    };
+
+    static std::size_t hash(const char pattern[])
+    {
+        const std::size_t address = reinterpret_cast<std::size_t>(pattern);
+        return (address ^ (address >> 13)) & (TableSize - 1);
+    }
+
+    void clear()
+    {
+        for (std::vector<Entry>::iterator it = _entries.begin(); it != _entries.end(); ++it)
         {
-            return false;
+            delete it->compiled;
+            *it = Entry();
         }
+        _used = 0;
+    }
 
-        while (*p && *p != ' ')
-            ++p;
+    // Not implemented..
+    PatternCache(const PatternCache &);
+    PatternCache &operator=(const PatternCache &);
 
-        tok = tok->next();
-    }
+    std::vector<Entry> _entries;
+    std::size_t _used;
+};
 
-    // The end of the pattern has been reached and nothing wrong has been found
-    return true;
+/** @brief The compiled patterns of the calling thread */
+static THREAD_LOCAL PatternCache *patternCache = 0;
+
+bool Token::Match(const Token *tok, const char pattern[], unsigned int varid)
+{
+    if (!patternCache)
+        patternCache = new PatternCache;
+    return patternCache->get(pattern).match(tok, varid);
+}
+
+void Token::clearMatchCache()
+{
+    delete patternCache;
+    patternCache = 0;
 }
 
 size_t Token::getStrLength(const Token *tok)
@@ -585,15 +1243,6 @@ size_t Token::getStrLength(const Token *tok)
     return len;
 }
 
-bool Token::isStandardType() const
-{
-    bool ret = false;
-    const char *type[] = {"bool", "char", "short", "int", "long", "float", "double", "size_t", 0};
-    for (int i = 0; type[i]; i++)
-        ret |= (_str == type[i]);
-    return ret;
-}
-
 void Token::move(Token *srcStart, Token *srcEnd, Token *newLocation)
 {
     /**[newLocation] -> b -> c -> [srcStart] -> [srcEnd] -> f */
@@ -639,7 +1288,7 @@ const Token *Token::findmatch(const Token *tok, const char pattern[], const Toke
 
 void Token::insertToken(const std::string &tokenStr)
 {
-    Token *newToken = new Token(tokensBack);
+    Token *newToken = _pool ? new (*_pool) Token(tokensBack, _pool) : new Token(tokensBack);
     newToken->str(tokenStr);
     newToken->_linenr = _linenr;
     newToken->_fileIndex = _fileIndex;
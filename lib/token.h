@@ -19,12 +19,51 @@
 #ifndef TokenH
 #define TokenH
 
+#include <cstddef>
 #include <string>
 #include <vector>
 
 /// @addtogroup Core
 /// @{
 
+/**
+ * @brief Memory for the tokens of a Tokenizer. The tokens are taken from
+ * big blocks and the deleted tokens are reused, that is a lot cheaper
+ * than allocating each token from the heap. The blocks are freed
+ * together when the pool is destroyed.
+ */
+class TokenPool
+{
+public:
+    TokenPool();
+
+    /** @brief Free the blocks. All tokens of the pool must be deleted. */
+    ~TokenPool();
+
+    /** @brief Memory for a token and the pool pointer before it */
+    void *allocate();
+
+    /** @brief Return memory that allocate() gave */
+    void deallocate(void *p);
+
+private:
+    /** @brief A deleted token is a link in the list of free tokens */
+    struct FreeSlot
+    {
+        FreeSlot *next;
+    };
+
+    void addBlock();
+
+    std::vector<char *> _blocks;
+    FreeSlot *_free;
+    std::size_t _used;
+
+    // Not implemented..
+    TokenPool(const TokenPool &);
+    TokenPool &operator=(const TokenPool &);
+};
+
 /**
  * @brief The token list that the Tokenizer generates is a linked-list of this class.
  *
@@ -42,18 +81,56 @@ private:
 
     // Not implemented..
     Token();
+    Token(const Token &);
+    Token &operator=(const Token &);
 
 public:
-    Token(Token **tokensBack);
+    /**
+     * @param tokensBack the back of the token list, it is updated when a
+     * token is added at the end
+     * @param pool the pool that the token is allocated from. The tokens
+     * that insertToken() adds are allocated from it too.
+     */
+    Token(Token **tokensBack, TokenPool *pool = 0);
     ~Token();
 
+    /**
+     * The pool that a token is allocated from is stored before the
+     * token, so delete returns it to that pool. Tokens that are not
+     * allocated from a pool are allocated from the heap.
+     */
+    static void *operator new(std::size_t size);
+    static void *operator new(std::size_t size, TokenPool &pool);
+    static void operator delete(void *p);
+    static void operator delete(void *p, TokenPool &pool);
+
+    /**
+     * Free the token strings of the calling thread. Threads that create
+     * tokens should call this before they exit, when all their tokens
+     * are deleted.
+     */
+    static void releaseMemory();
+
     void str(const std::string &s);
 
     void concatStr(std::string const& b);
 
+    /**
+     * The text of the token. Tokens with the same text that are created
+     * by the same thread share the string, see Match().
+     */
     const std::string &str() const
     {
-        return _str;
+        return *_str;
+    }
+
+    /**
+     * Id of the text if it is a keyword, a punctuator or empty. The ids
+     * are the same in all threads. Other texts have the id 0.
+     */
+    unsigned int strId() const
+    {
+        return _strId;
     }
 
     /**
@@ -117,6 +194,11 @@ public:
      * "const" or "void" and token after that is '{'. If even one of the tokens does not
      * match its pattern, false is returned.
      *
+     * The pattern is compiled the first time it is used and the compiled
+     * pattern is cached by the address of the pattern string, so pass
+     * string literals when possible. Each thread has its own cache, see
+     * clearMatchCache().
+     *
      * @todo pattern "%type%|%num%" should mean either a type or a num.
      *
      * @param tok List of tokens to be compared to the pattern
@@ -128,6 +210,12 @@ public:
      */
     static bool Match(const Token *tok, const char pattern[], unsigned int varid = 0);
 
+    /**
+     * Free the patterns that Match() has compiled in the calling thread.
+     * Threads that use Match() should call this before they exit.
+     */
+    static void clearMatchCache();
+
     /**
      * Return length of C-string.
      *
@@ -193,7 +281,53 @@ public:
     {
         _isUnused = used;
     }
-    bool isStandardType() const;
+
+    /**
+     * Kinds of tokens that only depend on the text of the token. A token
+     * can be of several kinds, e.g. "int" is a keyword and a standard type.
+     */
+    enum Kind
+    {
+        eKeyword = 0x1,
+        eStandardType = 0x2,        // bool, char, short, int, long, float, double, size_t
+        eString = 0x4,              // "..."
+        eChar = 0x8,                // '...'
+        eBracket = 0x10,            // ( ) [ ] { }
+        eAssignmentOp = 0x20,       // = += -= *= /= %= &= |= ^= <<= >>=
+        eComparisonOp = 0x40,       // == != < <= > >=
+        eArithmeticalOp = 0x80,     // + - * / % << >>
+        eLogicalOp = 0x100,         // && || !
+        eBitOp = 0x200              // & | ^ ~
+    };
+
+    /**
+     * Is the token of any of the given kinds?
+     * @param kinds Kind flags, e.g. (eString | eChar)
+     */
+    bool isKind(unsigned int kinds) const
+    {
+        return bool((_kind & kinds) != 0);
+    }
+    bool isKeyword() const
+    {
+        return isKind(eKeyword);
+    }
+    bool isStandardType() const
+    {
+        return isKind(eStandardType);
+    }
+    bool isString() const
+    {
+        return isKind(eString);
+    }
+    bool isChar() const
+    {
+        return isKind(eChar);
+    }
+    bool isAssignmentOp() const
+    {
+        return isKind(eAssignmentOp);
+    }
 
     static const Token *findmatch(const Token *tok, const char pattern[], unsigned int varId = 0);
     static const Token *findmatch(const Token *tok, const char pattern[], const Token *end, unsigned int varId = 0);
@@ -377,29 +511,8 @@ private:
         _previous = previousToken;
     }
 
-    /**
-     * Works almost like strcmp() except returns only 0 or 1 and
-     * if str has empty space &apos; &apos; character, that character is handled
-     * as if it were &apos;\\0&apos;
-     */
-    static int firstWordEquals(const char *str, const char *word);
-
-    /**
-     * Works almost like strchr() except
-     * if str has empty space &apos; &apos; character, that character is handled
-     * as if it were &apos;\\0&apos;
-     */
-    static const char *chrInFirstWord(const char *str, char c);
-
-    /**
-     * Works almost like strlen() except
-     * if str has empty space &apos; &apos; character, that character is handled
-     * as if it were &apos;\\0&apos;
-     */
-    static int firstWordLen(const char *str);
-
-
-    std::string _str;
+    /** Shared string from the string table of the thread that created the token */
+    const std::string *_str;
     bool _isName;
     bool _isNumber;
     bool _isBoolean;
@@ -407,6 +520,13 @@ private:
     bool _isSigned;
     bool _isLong;
     bool _isUnused;
+
+    /** Kind flags of the text, see isKind() */
+    unsigned int _kind;
+
+    /** Id of the text, see strId() */
+    unsigned int _strId;
+
     unsigned int _varId;
     Token *_next;
     Token *_previous;
@@ -419,6 +539,9 @@ private:
      * list this token is located.
      */
     unsigned int _progressValue;
+
+    /** @brief The pool of the inserted tokens, 0 for the heap */
+    TokenPool * const _pool;
 };
 
 /// @}
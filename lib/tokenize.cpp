@@ -30,6 +30,8 @@
 #include "check.h"
 #include "path.h"
 #include "symboldatabase.h"
+#include "timer.h"
+#include "progress.h"
 
 #include <locale>
 #include <fstream>
@@ -50,6 +52,7 @@ Tokenizer::Tokenizer()
     : _settings(0), _errorLogger(0)
 {
     // No tokens to start with
+    _tokenPool = new TokenPool;
     _tokens = 0;
     _tokensBack = 0;
 
@@ -59,8 +62,18 @@ Tokenizer::Tokenizer()
     // symbol database
     _symbolDatabase = NULL;
 
+    // bodies
+    _bodiesBuilt = false;
+    _bodiesVersion = 0;
+
+    // token list version
+    _tokensVersion = 0;
+
     // variable count
     _varId = 0;
+
+    // unnamed struct/union/enum/class count
+    _unnamedCount = 0;
 }
 
 Tokenizer::Tokenizer(const Settings *settings, ErrorLogger *errorLogger)
@@ -70,6 +83,7 @@ Tokenizer::Tokenizer(const Settings *settings, ErrorLogger *errorLogger)
     assert(_settings);
 
     // No tokens to start with
+    _tokenPool = new TokenPool;
     _tokens = 0;
     _tokensBack = 0;
 
@@ -79,14 +93,25 @@ Tokenizer::Tokenizer(const Settings *settings, ErrorLogger *errorLogger)
     // symbol database
     _symbolDatabase = NULL;
 
+    // bodies
+    _bodiesBuilt = false;
+    _bodiesVersion = 0;
+
+    // token list version
+    _tokensVersion = 0;
+
     // variable count
     _varId = 0;
+
+    // unnamed struct/union/enum/class count
+    _unnamedCount = 0;
 }
 
 Tokenizer::~Tokenizer()
 {
     deallocateTokens();
     delete _symbolDatabase;
+    delete _tokenPool;
 }
 
 //---------------------------------------------------------------------------
@@ -156,7 +181,7 @@ void Tokenizer::addtoken(const char str[], const unsigned int lineno, const unsi
     }
     else
     {
-        _tokens = new Token(&_tokensBack);
+        _tokens = new (*_tokenPool) Token(&_tokensBack, _tokenPool);
         _tokensBack = _tokens;
         _tokensBack->str(str2.str());
     }
@@ -187,7 +212,7 @@ void Tokenizer::addtoken(const Token * tok, const unsigned int lineno, const uns
     }
     else
     {
-        _tokens = new Token(&_tokensBack);
+        _tokens = new (*_tokenPool) Token(&_tokensBack, _tokenPool);
         _tokensBack = _tokens;
         _tokensBack->str(str2.str());
     }
@@ -212,7 +237,7 @@ unsigned int Tokenizer::sizeOfType(const Token *type) const
     if (!type || type->str().empty())
         return 0;
 
-    if (type->str()[0] == '"')
+    if (type->isString())
         return static_cast<unsigned int>(Token::getStrLength(type) + 1);
 
     std::map<std::string, unsigned int>::const_iterator it = _typeSize.find(type->str());
@@ -797,7 +822,7 @@ struct Space
     const Token * classEnd;
 };
 
-static Token *splitDefinitionFromTypedef(Token *tok)
+static Token *splitDefinitionFromTypedef(Token *tok, unsigned int &unnamedCount)
 {
     Token *tok1;
     std::string name;
@@ -820,8 +845,7 @@ static Token *splitDefinitionFromTypedef(Token *tok)
                 name = tok1->next()->str();
             else // create a unique name
             {
-                static long count = 0;
-                name = "Unnamed" + MathLib::toString<long>(count++);
+                name = "Unnamed" + MathLib::toString<unsigned int>(unnamedCount++);
             }
             tok->tokAt(1)->insertToken(name.c_str());
         }
@@ -949,10 +973,10 @@ void Tokenizer::simplifyTypedef()
     bool isNamespace = false;
     std::string className;
     bool hasClass = false;
+    Progress progress(_files.empty() ? "" : _files[0], "Tokenize (typedef)");
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
-        if (_errorLogger && !_files.empty())
-            _errorLogger->reportProgress(_files[0], "Tokenize (typedef)", tok->progressValue());
+        progress.value(tok->progressValue());
 
         if (Token::Match(tok, "class|struct|namespace %any%") &&
             (!tok->previous() || (tok->previous() && tok->previous()->str() != "enum")))
@@ -998,7 +1022,7 @@ void Tokenizer::simplifyTypedef()
         if (Token::Match(tok->next(), "const| struct|enum|union|class %type% {") ||
             Token::Match(tok->next(), "const| struct|enum|union|class {"))
         {
-            Token *tok1 = splitDefinitionFromTypedef(tok);
+            Token *tok1 = splitDefinitionFromTypedef(tok, _unnamedCount);
             if (!tok1)
                 continue;
             tok = tok1;
@@ -1010,7 +1034,7 @@ void Tokenizer::simplifyTypedef()
                 tok1 = tok1->next();
             if (tok1 && tok1->str() == "{")
             {
-                tok1 = splitDefinitionFromTypedef(tok);
+                tok1 = splitDefinitionFromTypedef(tok, _unnamedCount);
                 if (!tok1)
                     continue;
                 tok = tok1;
@@ -1916,6 +1940,30 @@ void Tokenizer::simplifyTypedef()
     }
 }
 
+/**
+ * Starts a new version of the token list when a simplification phase
+ * begins and when it ends, whichever way it returns.
+ */
+class TokensVersionScope
+{
+public:
+    explicit TokensVersionScope(Tokenizer &tokenizer) : _tokenizer(tokenizer)
+    {
+        _tokenizer.newTokensVersion();
+    }
+
+    ~TokensVersionScope()
+    {
+        _tokenizer.newTokensVersion();
+    }
+
+private:
+    Tokenizer &_tokenizer;
+
+    TokensVersionScope(const TokensVersionScope &);
+    TokensVersionScope &operator=(const TokensVersionScope &);
+};
+
 bool Tokenizer::tokenize(std::istream &code,
                          const char FileName[],
                          const std::string &configuration,
@@ -1924,12 +1972,17 @@ bool Tokenizer::tokenize(std::istream &code,
     // make sure settings specified
     assert(_settings);
 
+    // the tokens change, data derived from them is rebuilt afterwards
+    TokensVersionScope tokensVersionScope(*this);
+
     _configuration = configuration;
 
     // The "_files" vector remembers what files have been tokenized..
     _files.push_back(Path::simplifyPath(FileName));
 
+    Timer timerCreateTokens("Tokenizer::createTokens", _settings->_showtime);
     createTokens(code);
+    timerCreateTokens.Stop();
 
     // Convert C# code
     if (_files[0].find(".cs"))
@@ -2327,7 +2380,9 @@ bool Tokenizer::tokenize(std::istream &code,
     }
 
     // typedef..
+    Timer timerTypedef("Tokenizer::simplifyTypedef", _settings->_showtime);
     simplifyTypedef();
+    timerTypedef.Stop();
 
     // catch bad typedef canonicalization
     if (!validate())
@@ -2393,7 +2448,9 @@ bool Tokenizer::tokenize(std::istream &code,
     simplifyRedundantParanthesis();
 
     // Handle templates..
+    Timer timerTemplates("Tokenizer::simplifyTemplates", _settings->_showtime);
     simplifyTemplates();
+    timerTemplates.Stop();
 
     // Simplify templates.. sometimes the "simplifyTemplates" fail and
     // then unsimplified function calls etc remain. These have the
@@ -2427,7 +2484,9 @@ bool Tokenizer::tokenize(std::istream &code,
 
     if (!preprocessorCondition)
     {
+        Timer timerVarId("Tokenizer::setVarId", _settings->_showtime);
         setVarId();
+        timerVarId.Stop();
 
         // Change initialisation of variable to assignment
         simplifyInitVar();
@@ -3307,7 +3366,224 @@ std::string Tokenizer::getNameForFunctionParams(const Token *start)
     return result;
 }
 
-void Tokenizer::setVarId()
+/**
+ * Set varid for the usages of a declared variable. The scope of the
+ * variable is walked through from the declaration until its end.
+ * @param start first token after the type of the variable
+ * @param varname name of the variable
+ * @param varid id to set
+ */
+static void setVarIdInScope(Token *start, const std::string &varname, unsigned int varid)
+{
+    int indentlevel = 0;
+    int parlevel = 0;
+    bool funcDeclaration = false;
+    for (Token *tok2 = start; tok2; tok2 = tok2->next())
+    {
+        const char c = tok2->str()[0];
+        if (c == varname[0])
+        {
+            const std::string &prev = tok2->strAt(-1);
+            if (tok2->str() == varname && prev != "struct" && prev != "union" && prev != "::" && prev != "." && tok2->strAt(1) != "::")
+                tok2->varId(varid);
+        }
+        else if (c == '{')
+            ++indentlevel;
+        else if (c == '}')
+        {
+            --indentlevel;
+            if (indentlevel < 0)
+                break;
+
+            // We have reached the end of a loop: "for( int i;;) {  }"
+            if (funcDeclaration && indentlevel <= 0)
+                break;
+        }
+        else if (c == '(')
+            ++parlevel;
+        else if (c == ')')
+        {
+            // Is this a function parameter or a variable declared in for example a for loop?
+            if (parlevel == 0 && indentlevel == 0 && Token::Match(tok2, ") const| {"))
+                funcDeclaration = true;
+            else
+                --parlevel;
+        }
+        else if (parlevel < 0 && c == ';')
+            break;
+    }
+}
+
+/**
+ * @brief Index of the tokens that is used by Tokenizer::setVarId().
+ *
+ * Walking through the scope of every declared variable is slow for long
+ * functions. Instead the positions where each name is used are stored,
+ * the brackets that enclose the declarations are tracked while the
+ * declarations are found and the end of a scope is located through the
+ * bracket links. The variable ids are the same as setVarIdInScope() gives.
+ */
+class VarIdIndex
+{
+public:
+    explicit VarIdIndex(Token *tokens);
+
+    /** Can the index be used? All the brackets must be linked. */
+    bool valid() const
+    {
+        return _valid;
+    }
+
+    /**
+     * Set varid for the usages of a declared variable. The declarations
+     * must be handled in the order they are found in the code.
+     * @param start first token after the type of the variable
+     * @param varname name of the variable
+     * @param varid id to set
+     */
+    void setVarId(Token *start, const std::string &varname, unsigned int varid);
+
+private:
+    /** Position of the token in the token list */
+    unsigned int position(const Token *tok) const;
+
+    /**
+     * Get the token where the scope of a variable that is declared at
+     * position _cursor ends. The scope is given by _brackets.
+     * @return the end of the scope, or 0 if it is the end of the tokens
+     */
+    Token *scopeEnd() const;
+
+    /** All tokens */
+    std::vector<Token *> _tokens;
+
+    /** Tokens and their positions, sorted by token */
+    std::vector<std::pair<const Token *, unsigned int> > _positions;
+
+    /** Positions of the tokens where each name can be a variable */
+    std::map<std::string, std::vector<unsigned int> > _usages;
+
+    /** The "(" and "{" that enclose the token at position _cursor */
+    std::vector<Token *> _brackets;
+    unsigned int _cursor;
+
+    bool _valid;
+};
+
+VarIdIndex::VarIdIndex(Token *tokens)
+    : _cursor(0), _valid(true)
+{
+    for (Token *tok = tokens; tok; tok = tok->next())
+    {
+        const unsigned int pos = static_cast<unsigned int>(_tokens.size());
+        _tokens.push_back(tok);
+        _positions.push_back(std::make_pair(tok, pos));
+
+        if (tok->isName())
+        {
+            const Token *prev = tok->previous();
+            if (!(prev && (prev->str() == "struct" || prev->str() == "union" || prev->str() == "::" || prev->str() == ".")) &&
+                !Token::simpleMatch(tok->next(), "::"))
+                _usages[tok->str()].push_back(pos);
+        }
+        else if (!tok->link() && tok->str().size() == 1 && std::strchr("(){}[]", tok->str()[0]))
+            _valid = false;
+    }
+
+    std::sort(_positions.begin(), _positions.end());
+}
+
+unsigned int VarIdIndex::position(const Token *tok) const
+{
+    return std::lower_bound(_positions.begin(), _positions.end(), std::make_pair(tok, 0U))->second;
+}
+
+Token *VarIdIndex::scopeEnd() const
+{
+    // Declared in the global scope
+    if (_brackets.empty())
+        return 0;
+
+    // Declared in a block
+    if (_brackets.back()->str() == "{")
+        return _brackets.back()->link();
+
+    // Declared in parentheses: function parameter or for example a variable in a for loop
+    Token *tok = _brackets.back()->link();
+    if (Token::Match(tok, ") const| {"))
+        return tok->strAt(1) == "{" ? tok->next()->link() : tok->tokAt(2)->link();
+
+    // The scope ends after the parentheses. Step through the code like
+    // setVarIdInScope() does until the end of the scope is found.
+    int indentlevel = 0;
+    int parlevel = -1;
+    bool funcDeclaration = false;
+    for (tok = tok->next(); tok; tok = tok->next())
+    {
+        char c = tok->str()[0];
+
+        // Skip parentheses if nothing in them can end the scope
+        if (c == '(' && parlevel >= -1 && !(funcDeclaration && indentlevel == 0))
+        {
+            ++parlevel;
+            tok = tok->link();
+            c = ')';
+        }
+
+        if (c == '{')
+            ++indentlevel;
+        else if (c == '}')
+        {
+            --indentlevel;
+            if (indentlevel < 0 || (funcDeclaration && indentlevel <= 0))
+                return tok;
+        }
+        else if (c == '(')
+            ++parlevel;
+        else if (c == ')')
+        {
+            if (parlevel == 0 && indentlevel == 0 && Token::Match(tok, ") const| {"))
+                funcDeclaration = true;
+            else
+                --parlevel;
+        }
+        else if (parlevel < 0 && c == ';')
+            return tok;
+    }
+    return 0;
+}
+
+void VarIdIndex::setVarId(Token *start, const std::string &varname, unsigned int varid)
+{
+    const unsigned int startPos = position(start);
+    if (startPos < _cursor)
+    {
+        setVarIdInScope(start, varname, varid);
+        return;
+    }
+
+    // Update the brackets that enclose the declaration
+    for (; _cursor < startPos; ++_cursor)
+    {
+        Token * const tok = _tokens[_cursor];
+        if (tok->str() == "(" || tok->str() == "{")
+            _brackets.push_back(tok);
+        else if ((tok->str() == ")" || tok->str() == "}") && !_brackets.empty())
+            _brackets.pop_back();
+    }
+
+    std::map<std::string, std::vector<unsigned int> >::const_iterator usages = _usages.find(varname);
+    if (usages == _usages.end())
+        return;
+
+    const Token * const end = scopeEnd();
+    const unsigned int endPos = end ? position(end) : static_cast<unsigned int>(_tokens.size());
+    const std::vector<unsigned int> &positions = usages->second;
+    for (std::vector<unsigned int>::const_iterator it = std::lower_bound(positions.begin(), positions.end(), startPos); it != positions.end() && *it < endPos; ++it)
+        _tokens[*it]->varId(varid);
+}
+
+void Tokenizer::setVarId(bool scopeIndex)
 {
     // Clear all variable ids
     for (Token *tok = _tokens; tok; tok = tok->next())
@@ -3315,13 +3591,15 @@ void Tokenizer::setVarId()
 
     // Set variable ids..
     _varId = 0;
+    VarIdIndex index(scopeIndex ? _tokens : 0);
+    scopeIndex = scopeIndex && index.valid();
+    Progress progress(_files.empty() ? "" : _files[0], "Tokenize (set variable id)");
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
         if (tok != _tokens && !Token::Match(tok, "[;{}(,] %type%"))
             continue;
 
-        if (_errorLogger)
-            _errorLogger->reportProgress(_files[0], "Tokenize (set variable id)", tok->progressValue());
+        progress.value(tok->progressValue());
 
         // If pattern is "( %type% *|& %var% )" then check if it's a
         // variable declaration or a multiplication / mask
@@ -3492,8 +3770,7 @@ void Tokenizer::setVarId()
             // Search for function declaration, e.g. void f( int c );
             if (Token::Match(tok2->next(), "%num%") ||
                 Token::Match(tok2->next(), "%bool%") ||
-                tok2->next()->str()[0] == '"' ||
-                tok2->next()->str()[0] == '\'' ||
+                tok2->next()->isKind(Token::eString | Token::eChar) ||
                 tok2->next()->varId() != 0)
             {
                 // This is not a function
@@ -3508,43 +3785,10 @@ void Tokenizer::setVarId()
         if (Token::Match(tok2, "[,();[=]") && !varname.empty())
         {
             ++_varId;
-            int indentlevel = 0;
-            int parlevel = 0;
-            bool funcDeclaration = false;
-            for (tok2 = tok->next(); tok2; tok2 = tok2->next())
-            {
-                const char c = tok2->str()[0];
-                if (c == varname[0])
-                {
-                    const std::string &prev = tok2->strAt(-1);
-                    if (tok2->str() == varname && prev != "struct" && prev != "union" && prev != "::" && prev != "." && tok2->strAt(1) != "::")
-                        tok2->varId(_varId);
-                }
-                else if (c == '{')
-                    ++indentlevel;
-                else if (c == '}')
-                {
-                    --indentlevel;
-                    if (indentlevel < 0)
-                        break;
-
-                    // We have reached the end of a loop: "for( int i;;) {  }"
-                    if (funcDeclaration && indentlevel <= 0)
-                        break;
-                }
-                else if (c == '(')
-                    ++parlevel;
-                else if (c == ')')
-                {
-                    // Is this a function parameter or a variable declared in for example a for loop?
-                    if (parlevel == 0 && indentlevel == 0 && Token::Match(tok2, ") const| {"))
-                        funcDeclaration = true;
-                    else
-                        --parlevel;
-                }
-                else if (parlevel < 0 && c == ';')
-                    break;
-            }
+            if (scopeIndex)
+                index.setVarId(tok->next(), varname, _varId);
+            else
+                setVarIdInScope(tok->next(), varname, _varId);
         }
     }
 
@@ -4090,9 +4334,8 @@ void Tokenizer::simplifySizeof()
 
 bool Tokenizer::simplifyTokenList()
 {
-    // clear the _functionList so it can't contain dead pointers
-    delete _symbolDatabase;
-    _symbolDatabase = NULL;
+    // the tokens change, data derived from them is rebuilt afterwards
+    TokensVersionScope tokensVersionScope(*this);
 
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
@@ -4110,7 +4353,7 @@ bool Tokenizer::simplifyTokenList()
     // Combine wide strings
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
-        while (tok->str() == "L" && tok->next() && tok->next()->str()[0] == '"')
+        while (tok->str() == "L" && tok->next() && tok->next()->isString())
         {
             // Combine 'L "string"'
             tok->str(tok->next()->str());
@@ -4121,11 +4364,11 @@ bool Tokenizer::simplifyTokenList()
     // Combine strings
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
-        if (tok->str()[0] != '"')
+        if (!tok->isString())
             continue;
 
         tok->str(simplifyString(tok->str()));
-        while (tok->next() && tok->next()->str()[0] == '"')
+        while (tok->next() && tok->next()->isString())
         {
             tok->next()->str(simplifyString(tok->next()->str()));
 
@@ -4190,7 +4433,9 @@ bool Tokenizer::simplifyTokenList()
     simplifySizeof();
 
     // replace strlen(str)
+    Timer timerKnownVariables("Tokenizer::simplifyKnownVariables", _settings->_showtime);
     simplifyKnownVariables();
+    timerKnownVariables.Stop();
     for (Token *tok = _tokens; tok; tok = tok->next())
     {
         if (Token::Match(tok, "strlen ( %str% )"))
@@ -4364,7 +4609,9 @@ bool Tokenizer::simplifyTokenList()
     }
 
     // In case variable declarations have been updated...
+    Timer timerVarId("Tokenizer::setVarId", _settings->_showtime);
     setVarId();
+    timerVarId.Stop();
 
     bool modified = true;
     while (modified)
@@ -8129,20 +8376,9 @@ void Tokenizer::simplifyStd()
 
 const Token *Tokenizer::getFunctionTokenByName(const char funcname[]) const
 {
-    getSymbolDatabase();
-
-    std::list<Scope *>::const_iterator i;
-
-    for (i = _symbolDatabase->scopeList.begin(); i != _symbolDatabase->scopeList.end(); ++i)
-    {
-        const Scope *scope = *i;
-
-        if (scope->type == Scope::eFunction)
-        {
-            if (scope->classDef->str() == funcname)
-                return scope->classDef;
-        }
-    }
+    const Scope *scope = getSymbolDatabase()->findFunctionScopeByName(funcname);
+    if (scope)
+        return scope->classDef;
     return NULL;
 }
 
@@ -8157,6 +8393,7 @@ void Tokenizer::fillFunctionList()
 // Deallocate lists..
 void Tokenizer::deallocateTokens()
 {
+    newTokensVersion();
     deleteTokens(_tokens);
     _tokens = 0;
     _tokensBack = 0;
@@ -9424,12 +9661,41 @@ void Tokenizer::simplifyQtSignalsSlots()
 
 const SymbolDatabase *Tokenizer::getSymbolDatabase() const
 {
+    // Built for an older version of the tokens?
+    if (_symbolDatabase && _symbolDatabase->tokensVersion() != _tokensVersion)
+    {
+        delete _symbolDatabase;
+        _symbolDatabase = NULL;
+    }
+
     if (!_symbolDatabase)
         _symbolDatabase = new SymbolDatabase(this, _settings, _errorLogger);
 
     return _symbolDatabase;
 }
 
+const std::vector<const Token *> &Tokenizer::getBodies() const
+{
+    if (!_bodiesBuilt || _bodiesVersion != _tokensVersion)
+    {
+        _bodies.clear();
+        for (const Token *tok = _tokens; tok; tok = tok->next())
+        {
+            if (tok->str() == ")" && Token::Match(tok, ") const| {"))
+                _bodies.push_back(tok->next()->str() == "const" ? tok->tokAt(2) : tok->next());
+        }
+        _bodiesBuilt = true;
+        _bodiesVersion = _tokensVersion;
+    }
+
+    return _bodies;
+}
+
+void Tokenizer::newTokensVersion()
+{
+    ++_tokensVersion;
+}
+
 void Tokenizer::simplifyOperatorName()
 {
     for (Token *tok = _tokens; tok; tok = tok->next())
@@ -29,6 +29,7 @@
 #include <set>
 
 class Token;
+class TokenPool;
 class ErrorLogger;
 class Settings;
 class SymbolDatabase;
@@ -97,8 +98,13 @@ public:
      */
     void createTokens(std::istream &code);
 
-    /** Set variable id */
-    void setVarId();
+    /**
+     * Set variable id
+     * @param scopeIndex find the usages of each variable through an
+     * index instead of walking through its whole scope. The result is
+     * the same, the index is faster for long functions.
+     */
+    void setVarId(bool scopeIndex = true);
 
     /**
      * Simplify tokenlist
@@ -145,7 +151,7 @@ public:
      */
     const std::vector<std::string> *getFiles() const;
 
-    /** recreate symbol database */
+    /** create the symbol database for the current token list */
     void fillFunctionList();
 
     /**
@@ -646,8 +652,41 @@ public:
         _settings = settings;
     }
 
+    /**
+     * @brief Symbol database. Built the first time it is needed and shared
+     * by all checks. It is built again if it was built for an older
+     * version of the token list.
+     */
     const SymbolDatabase *getSymbolDatabase() const;
 
+    /**
+     * @brief Every "{" that follows ") const|": the function bodies and the
+     * bodies of if, loops, switch, catch, etc. Built the first time it is
+     * needed and shared by the ExecutionPath checks. Built again if the
+     * version of the token list has changed.
+     */
+    const std::vector<const Token *> &getBodies() const;
+
+    /**
+     * @brief Version of the token list.
+     * The symbol database, the bodies and any other data that is derived
+     * from the tokens record the version they were built for, and the
+     * getters build them again when the version has changed. tokenize() and
+     * simplifyTokenList() start a new version when they begin and when
+     * they are done, so data built while they change the tokens is not used
+     * afterwards.
+     */
+    unsigned int tokensVersion() const
+    {
+        return _tokensVersion;
+    }
+
+    /**
+     * @brief The token list has changed. Start a new version, the data that
+     * is derived from the old tokens is not used anymore.
+     */
+    void newTokensVersion();
+
     Token *deleteInvalidTypedef(Token *typeDef);
 
     /**
@@ -666,6 +705,9 @@ private:
     /** Disable assignment operator, no implementation */
     Tokenizer &operator=(const Tokenizer &);
 
+    /** Memory for the tokens, it is freed when the Tokenizer is destroyed */
+    TokenPool *_tokenPool;
+
     /** Token list */
     Token *_tokens, *_tokensBack;
 
@@ -694,8 +736,23 @@ private:
     /** Symbol database that all checks etc can use */
     mutable SymbolDatabase *_symbolDatabase;
 
+    /** Bodies that all checks etc can use, see getBodies() */
+    mutable std::vector<const Token *> _bodies;
+
+    /** Are the bodies built? */
+    mutable bool _bodiesBuilt;
+
+    /** version of the token list the bodies were built for */
+    mutable unsigned int _bodiesVersion;
+
+    /** version of the token list, see tokensVersion() */
+    unsigned int _tokensVersion;
+
     /** variable count */
     unsigned int _varId;
+
+    /** count of unnamed struct/union/enum/class definitions that got a name */
+    unsigned int _unnamedCount;
 };
 
 /// @}
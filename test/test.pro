@@ -43,6 +43,7 @@ HEADERS += ../cli/cmdlineparser.h \
 HEADERS += options.h redirect.h testsuite.h
 SOURCES += options.cpp \
            testautovariables.cpp \
+           testbenchmark.cpp \
            testbufferoverrun.cpp \
            testcharvar.cpp \
            testclass.cpp \
@@ -63,6 +64,8 @@ SOURCES += options.cpp \
            testpathmatch.cpp \
            testpostfixoperator.cpp \
            testpreprocessor.cpp \
+           testprogress.cpp \
+           testresultcache.cpp \
            testrunner.cpp \
            testsettings.cpp \
            testsimplifytokens.cpp \
@@ -70,6 +73,7 @@ SOURCES += options.cpp \
            testsuite.cpp \
            testsymboldatabase.cpp \
            testthreadexecutor.cpp \
+           testtimer.cpp \
            testtoken.cpp \
            testtokenize.cpp \
            testuninitvar.cpp \
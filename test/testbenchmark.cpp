@@ -0,0 +1,232 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmarks that compare different implementations of the same thing.
+// They are not run by default, run them with "./testrunner TestBenchmark".
+// The timing results are written to the output.
+
+#include "tokenize.h"
+#include "token.h"
+#include "settings.h"
+#include "symboldatabase.h"
+#include "timer.h"
+#include "testsuite.h"
+
+#include <sstream>
+
+class TestBenchmark : public TestFixture
+{
+public:
+    TestBenchmark() : TestFixture("TestBenchmark", true)
+    { }
+
+private:
+
+    void run()
+    {
+        TEST_CASE(setVarId);
+        TEST_CASE(symbolDatabaseLookups);
+    }
+
+    /**
+     * Generate a long function, like the functions that code generators create.
+     * @param statements number of generated statements
+     */
+    static std::string longFunction(unsigned int statements)
+    {
+        std::ostringstream code;
+        code << "struct S { int x; };\n"
+             << "int f(int a, struct S *s)\n"
+             << "{\n"
+             << "    int sum = 0;\n";
+        for (unsigned int i = 0; i < statements; ++i)
+        {
+            code << "    int v" << i << " = a + " << i << ";\n"
+                 << "    for (int i = 0; i < v" << i << "; i++)\n"
+                 << "    {\n"
+                 << "        int x = i * v" << (i / 2) << ";\n"
+                 << "        sum += x + s->x;\n"
+                 << "    }\n";
+        }
+        code << "    return sum;\n"
+             << "}\n";
+        return code.str();
+    }
+
+    void setVarId()
+    {
+        Settings settings;
+        Tokenizer tokenizer(&settings, this);
+        std::istringstream istr(longFunction(1000));
+        tokenizer.tokenize(istr, "test.cpp");
+
+        TimerResults results;
+
+        Timer timerScopeWalk("Tokenizer::setVarId (scope walk)", SHOWTIME_SUMMARY, &results);
+        tokenizer.setVarId(false);
+        timerScopeWalk.Stop();
+        const std::string expected(tokenizer.tokens()->stringifyList(true));
+
+        Timer timerScopeIndex("Tokenizer::setVarId (scope index)", SHOWTIME_SUMMARY, &results);
+        tokenizer.setVarId(true);
+        timerScopeIndex.Stop();
+
+        // Both implementations must give the same variable ids
+        ASSERT_EQUALS(expected, tokenizer.tokens()->stringifyList(true));
+
+        results.ShowResults();
+    }
+
+    /**
+     * Generate many classes, like the protocol code that code generators create.
+     * @param classes number of generated classes
+     */
+    static std::string manyClasses(unsigned int classes)
+    {
+        std::ostringstream code;
+        code << "namespace proto {\n";
+        for (unsigned int i = 0; i < classes; ++i)
+        {
+            code << "class Msg" << i << "\n"
+                 << "{\n"
+                 << "public:\n"
+                 << "    Msg" << i << "();\n"
+                 << "    int get() const;\n"
+                 << "    void set(int v);\n"
+                 << "private:\n"
+                 << "    int value;\n";
+            if (i > 0)
+                code << "    Msg" << (i - 1) << " *prev;\n";
+            code << "};\n"
+                 << "Msg" << i << "::Msg" << i << "() : value(0) { }\n"
+                 << "int Msg" << i << "::get() const { return value; }\n"
+                 << "void Msg" << i << "::set(int v) { value = v; }\n"
+                 << "void handle" << i << "(Msg" << i << " &m) { m.set(" << i << "); }\n";
+        }
+        code << "}\n";
+        return code.str();
+    }
+
+    /** The linear scan over scopeList that findVariableType used to do */
+    static const Scope *findVariableTypeScan(const SymbolDatabase *db, const Scope *start, const Token *type)
+    {
+        std::list<Scope *>::const_iterator it;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            const Scope *scope = *it;
+            if (scope->type == Scope::eNamespace || scope->type == Scope::eFunction || scope->type == Scope::eGlobal)
+                continue;
+            if (scope->className == type->str())
+            {
+                if (type->previous()->str() != "::")
+                {
+                    const Scope *parent = start;
+                    while (parent && parent != scope->nestedIn)
+                        parent = parent->nestedIn;
+                    if (scope->nestedIn == parent)
+                        return scope;
+                }
+                else
+                    return scope;
+            }
+        }
+        return NULL;
+    }
+
+    /** The linear scan over scopeList that findFunctionScopeByName replaces */
+    static const Scope *findFunctionScopeScan(const SymbolDatabase *db, const std::string &name)
+    {
+        std::list<Scope *>::const_iterator it;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            if ((*it)->type == Scope::eFunction && (*it)->className == name)
+                return *it;
+        }
+        return NULL;
+    }
+
+    void symbolDatabaseLookups()
+    {
+        Settings settings;
+        Tokenizer tokenizer(&settings, this);
+        std::istringstream istr(manyClasses(1000));
+        tokenizer.tokenize(istr, "test.cpp");
+
+        TimerResults results;
+
+        Timer timerCreate("SymbolDatabase::SymbolDatabase", SHOWTIME_SUMMARY, &results);
+        const SymbolDatabase *db = tokenizer.getSymbolDatabase();
+        timerCreate.Stop();
+
+        // every function must have been matched with its class
+        std::list<Scope *>::const_iterator it;
+        unsigned int functions = 0;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            if ((*it)->type == Scope::eFunction && (*it)->functionOf)
+                ++functions;
+        }
+        ASSERT_EQUALS(3 * 1000U, functions);
+
+        // look up the type of every variable declaration, in the scope it is in
+        std::vector<std::pair<const Scope *, const Token *> > lookups;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            if (!(*it)->classStart)
+                continue;
+            for (const Token *tok = (*it)->classStart; tok != (*it)->classEnd; tok = tok->next())
+            {
+                if (Token::Match(tok, "%type% *|&| %var% [;,)]"))
+                    lookups.push_back(std::make_pair(*it, tok));
+            }
+        }
+
+        std::vector<const Scope *> expected;
+        Timer timerScan("SymbolDatabase::findVariableType (scan)", SHOWTIME_SUMMARY, &results);
+        for (unsigned int i = 0; i < lookups.size(); ++i)
+            expected.push_back(findVariableTypeScan(db, lookups[i].first, lookups[i].second));
+        timerScan.Stop();
+
+        std::vector<const Scope *> actual;
+        Timer timerIndex("SymbolDatabase::findVariableType (index)", SHOWTIME_SUMMARY, &results);
+        for (unsigned int i = 0; i < lookups.size(); ++i)
+            actual.push_back(db->findVariableType(lookups[i].first, lookups[i].second));
+        timerIndex.Stop();
+
+        ASSERT(expected == actual);
+
+        // look up every function by name and by token
+        bool same = true;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            if ((*it)->type == Scope::eFunction)
+            {
+                same &= (db->findFunctionScopeByToken((*it)->classDef) == *it);
+                same &= (tokenizer.getFunctionTokenByName((*it)->className.c_str()) == findFunctionScopeScan(db, (*it)->className)->classDef);
+            }
+            std::list<Function>::const_iterator func;
+            for (func = (*it)->functionList.begin(); func != (*it)->functionList.end(); ++func)
+                same &= (db->findFunctionByToken(func->token) == &*func);
+        }
+        ASSERT_EQUALS(true, same);
+
+        results.ShowResults();
+    }
+};
+
+REGISTER_TEST(TestBenchmark)
@@ -19,6 +19,7 @@
 #include "testsuite.h"
 #include "cmdlineparser.h"
 #include "settings.h"
+#include "threadexecutor.h"
 #include "redirect.h"
 
 class TestCmdlineParser : public TestFixture
@@ -74,6 +75,11 @@ private:
         TEST_CASE(jobsMissingCount);
         TEST_CASE(jobsInvalid);
         TEST_CASE(reportProgress);
+        TEST_CASE(cacheDir);
+        TEST_CASE(cacheDirMissing);
+        TEST_CASE(executorThread);
+        TEST_CASE(executorProcess);
+        TEST_CASE(executorUnknown);
         TEST_CASE(suppressionsOld); // TODO: Create and test real suppression file
         TEST_CASE(suppressions)
         TEST_CASE(suppressionsNoFile)
@@ -527,6 +533,55 @@ private:
         ASSERT(settings.reportProgress);
     }
 
+    void cacheDir()
+    {
+        REDIRECT;
+        const char *argv[] = {"cppcheck", "--cache-dir=cache", "file.cpp"};
+        Settings settings;
+        CmdLineParser parser(&settings);
+        ASSERT(parser.ParseFromArgs(3, argv));
+        ASSERT_EQUALS("cache", settings._cacheDir);
+    }
+
+    void cacheDirMissing()
+    {
+        REDIRECT;
+        const char *argv[] = {"cppcheck", "--cache-dir=", "file.cpp"};
+        Settings settings;
+        CmdLineParser parser(&settings);
+        ASSERT(!parser.ParseFromArgs(3, argv));
+    }
+
+    void executorThread()
+    {
+        REDIRECT;
+        const char *argv[] = {"cppcheck", "-j2", "--executor=thread", "file.cpp"};
+        Settings settings;
+        settings._processExecutor = true;
+        CmdLineParser parser(&settings);
+        ASSERT(parser.ParseFromArgs(4, argv));
+        ASSERT_EQUALS(false, settings._processExecutor);
+    }
+
+    void executorProcess()
+    {
+        REDIRECT;
+        const char *argv[] = {"cppcheck", "-j2", "--executor=process", "file.cpp"};
+        Settings settings;
+        CmdLineParser parser(&settings);
+        ASSERT_EQUALS(ThreadExecutor::processesEnabled(), parser.ParseFromArgs(4, argv));
+        ASSERT_EQUALS(ThreadExecutor::processesEnabled(), settings._processExecutor);
+    }
+
+    void executorUnknown()
+    {
+        REDIRECT;
+        const char *argv[] = {"cppcheck", "-j2", "--executor=fiber", "file.cpp"};
+        Settings settings;
+        CmdLineParser parser(&settings);
+        ASSERT(!parser.ParseFromArgs(4, argv));
+    }
+
     void suppressionsOld()
     {
         // TODO: Fails because there is no suppr.txt file!
@@ -68,6 +68,7 @@ private:
     {
         TEST_CASE(instancesSorted);
         TEST_CASE(getErrorMessages);
+        TEST_CASE(identicalConfigurations);
     }
 
     void instancesSorted()
@@ -104,6 +105,20 @@ private:
         }
         ASSERT_EQUALS("", duplicate);
     }
+
+    void identicalConfigurations()
+    {
+        // The code is the same when A is defined, it is only checked once.
+        // The syntax error message would say which macros are defined.
+        ErrorLogger2 errorLogger;
+        CppCheck cppCheck(errorLogger, true);
+        cppCheck.addFile("test.c", "void f()\n"
+                         "{\n"
+                         "#ifdef A\n"
+                         "#endif\n");
+        cppCheck.check();
+        ASSERT_EQUALS(1, static_cast<int>(std::count(errorLogger.id.begin(), errorLogger.id.end(), "syntaxError")));
+    }
 };
 
 REGISTER_TEST(TestCppcheck)
@@ -40,6 +40,7 @@ private:
         TEST_CASE(ToXml);
         TEST_CASE(ToVerboseXml);
         TEST_CASE(ToXmlV2);
+        TEST_CASE(ReportedErrorsUnique);
     }
 
     void FileLocationDefaults()
@@ -162,5 +163,34 @@ private:
         message += "    <location file=\"foo.cpp\" line=\"5\"/>\n  </error>";
         ASSERT_EQUALS(message, msg.toXML(false,2));
     }
+
+    void ReportedErrorsUnique()
+    {
+        ErrorLogger::ErrorMessage::FileLocation loc;
+        loc.setfile("foo.cpp");
+        loc.line = 5;
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs(1, loc);
+        ErrorMessage msg1(locs, Severity::error, "Programming error.\nVerbose error", "errorId");
+        ErrorMessage msg2(locs, Severity::error, "Programming error.\nOther verbose error", "errorId");
+        ErrorMessage msg3(locs, Severity::style, "Programming error.\nVerbose error", "errorId");
+        ErrorMessage msg4(locs, Severity::error, "Programming error.\nVerbose error", "otherId");
+
+        ReportedErrors reported;
+        ASSERT_EQUALS(true, reported.insert(ReportedErrors::fingerprint(msg1, false)));
+        ASSERT_EQUALS(false, reported.insert(ReportedErrors::fingerprint(msg1, false)));
+        ASSERT_EQUALS(true, reported.contains(ReportedErrors::fingerprint(msg2, false)));
+        ASSERT_EQUALS(false, reported.contains(ReportedErrors::fingerprint(msg2, true)));
+        ASSERT_EQUALS(false, reported.contains(ReportedErrors::fingerprint(msg3, false)));
+        ASSERT_EQUALS(false, reported.contains(ReportedErrors::fingerprint(msg4, false)));
+
+        loc.line = 6;
+        locs.push_back(loc);
+        ErrorMessage msg5(locs, Severity::error, "Programming error.\nVerbose error", "errorId");
+        ASSERT_EQUALS(false, reported.contains(ReportedErrors::fingerprint(msg5, false)));
+
+        reported.clear();
+        ASSERT_EQUALS(false, reported.contains(ReportedErrors::fingerprint(msg1, false)));
+    }
 };
+
 REGISTER_TEST(TestErrorLogger)
@@ -170,6 +170,7 @@ private:
         TEST_CASE(simple9);     // Bug 2435468 - member function "free"
         TEST_CASE(simple11);
         TEST_CASE(new_nothrow);
+        TEST_CASE(multipleVariables);
 
         TEST_CASE(staticvar);
         TEST_CASE(externvar);
@@ -731,6 +732,17 @@ private:
         // #2635 - false negative
         ASSERT_EQUALS("; alloc ; return use ; }",
                       simplifycode("; alloc ; if(!var) { loop { ifv { } } alloc ; } return use; }"));
+
+        // deep nesting is reduced one level per pass, the positions
+        // around the changes must be simplified again
+        std::string nested("; alloc ; use ;");
+        for (unsigned int i = 0; i < 30; ++i)
+            nested += " if { use ;";
+        nested += " dealloc ; return ;";
+        for (unsigned int i = 0; i < 30; ++i)
+            nested += " }";
+        nested += " use ; use ; dealloc ; }";
+        ASSERT_EQUALS("; alloc ; dealloc ; }", simplifycode(nested.c_str()));
     }
 
 
@@ -939,6 +951,36 @@ private:
         ASSERT_EQUALS("", errout.str());
     }
 
+    void multipleVariables()
+    {
+        // The statements that don't use a variable are shared by the
+        // variables of the function
+        check("void f()\n"
+              "{\n"
+              "    char *a = malloc(10);\n"
+              "    char *b = malloc(10);\n"
+              "    if (x) {\n"
+              "        free(a);\n"
+              "        return;\n"
+              "    }\n"
+              "    if (y) {\n"
+              "        char *c = malloc(10);\n"
+              "        a[0] = 0;\n"
+              "    }\n"
+              "    int fd = open(\"a\", 0);\n"
+              "    if (z) {\n"
+              "        free(b);\n"
+              "        return;\n"
+              "    }\n"
+              "    free(b);\n"
+              "    free(a);\n"
+              "}\n");
+        ASSERT_EQUALS("[test.cpp:16]: (error) Memory leak: a\n"
+                      "[test.cpp:7]: (error) Memory leak: b\n"
+                      "[test.cpp:12]: (error) Memory leak: c\n"
+                      "[test.cpp:16]: (error) Resource leak: fd\n", errout.str());
+    }
+
 
     void staticvar()
     {
@@ -40,6 +40,7 @@ private:
         TEST_CASE(pointerDerefAndCheck);
         TEST_CASE(nullpointer5);    // References should not be checked
         TEST_CASE(nullpointerExecutionPaths);
+        TEST_CASE(nullpointerExecutionPathsMany);
         TEST_CASE(nullpointerExecutionPathsLoop);
         TEST_CASE(nullpointer7);
         TEST_CASE(nullpointer8);
@@ -712,6 +713,63 @@ private:
               "}");
         ASSERT_EQUALS("", errout.str());
 
+        // the pointer is assigned in the else branch
+        check("void f(int x, int *q) {\n"
+              "    int *p = 0;\n"
+              "    if (x) {\n"
+              "        x = 2;\n"
+              "    } else {\n"
+              "        p = q;\n"
+              "    }\n"
+              "    *p = 0;\n"
+              "}");
+        ASSERT_EQUALS("[test.cpp:8]: (error) Possible null pointer dereference: p\n", errout.str());
+
+        // null in both branches
+        check("void f(int x, int y) {\n"
+              "    int *p;\n"
+              "    if (x) {\n"
+              "        p = 0;\n"
+              "    } else {\n"
+              "        p = 0;\n"
+              "    }\n"
+              "    if (y) {\n"
+              "        y = 2;\n"
+              "    }\n"
+              "    *p = 0;\n"
+              "}");
+        ASSERT_EQUALS("[test.cpp:11]: (error) Possible null pointer dereference: p\n", errout.str());
+    }
+
+    // more than 10 execution paths
+    void nullpointerExecutionPathsMany()
+    {
+        check("void f(int x, int *q) {\n"
+              "    int *p1 = 0; int *p2 = 0; int *p3 = 0; int *p4 = 0;\n"
+              "    int *p5 = 0; int *p6 = 0; int *p7 = 0; int *p8 = 0;\n"
+              "    int *p9 = 0; int *p10 = 0; int *p11 = 0;\n"
+              "    if (x) {\n"
+              "        p11 = q;\n"
+              "    }\n"
+              "    *p11 = 0;\n"
+              "    g(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);\n"
+              "}");
+        ASSERT_EQUALS("[test.cpp:8]: (error) Possible null pointer dereference: p11\n", errout.str());
+
+        check("void f(int x, int *q) {\n"
+              "    int *p1 = 0; int *p2 = 0; int *p3 = 0; int *p4 = 0;\n"
+              "    int *p5 = 0; int *p6 = 0; int *p7 = 0; int *p8 = 0;\n"
+              "    int *p9 = 0; int *p10 = 0; int *p11 = 0;\n"
+              "    if (x == 1) { p1 = q; } else { p2 = q; }\n"
+              "    if (x == 2) { p3 = q; } else { p4 = q; }\n"
+              "    if (x == 3) { p5 = q; } else { p6 = q; }\n"
+              "    if (x == 4) { p7 = q; } else { p8 = q; }\n"
+              "    if (x == 5) { p9 = q; } else { p10 = q; }\n"
+              "    if (x == 6) { p11 = q; }\n"
+              "    *p11 = 0;\n"
+              "    g(p1, p2, p3, p4, p5, p6, p7, p8, p9, p10);\n"
+              "}");
+        ASSERT_EQUALS("[test.cpp:11]: (error) Possible null pointer dereference: p11\n", errout.str());
     }
 
     // Ticket #2350
@@ -23,11 +23,14 @@
 
 #include "testsuite.h"
 #include "preprocessor.h"
+#include "mappedfile.h"
 #include "tokenize.h"
 #include "token.h"
 #include "settings.h"
 
 #include <map>
+#include <fstream>
+#include <cstdio>
 #include <string>
 #include <sstream>
 #include <stdexcept>
@@ -67,6 +70,9 @@ private:
         // Just read the code into a string. Perform simple cleanup of the code
         TEST_CASE(readCode1);
         TEST_CASE(readCode2);
+        TEST_CASE(readCode3);
+        TEST_CASE(mappedFile);
+        TEST_CASE(headerCache);
 
         // The bug that started the whole work with the new preprocessor
         TEST_CASE(Bug2190219);
@@ -116,6 +122,7 @@ private:
 
         // Test the Preprocessor::match_cfg_def
         TEST_CASE(match_cfg_def);
+        TEST_CASE(match_cfg_def_many);
 
         TEST_CASE(if_cond1);
         TEST_CASE(if_cond2);
@@ -131,6 +138,7 @@ private:
 
         TEST_CASE(if_or_1);
         TEST_CASE(if_or_2);
+        TEST_CASE(if_cached);
 
         TEST_CASE(multiline1);
         TEST_CASE(multiline2);
@@ -159,6 +167,7 @@ private:
         TEST_CASE(macro_simple13);
         TEST_CASE(macro_simple14);
         TEST_CASE(macro_simple15);
+        TEST_CASE(macro_many);
         TEST_CASE(macroInMacro);
         TEST_CASE(macro_mismatch);
         TEST_CASE(macro_linenumbers);
@@ -241,6 +250,65 @@ private:
         ASSERT_EQUALS("\" \\\" /* abc */ \\n\"\n", codestr);
     }
 
+    void readCode3()
+    {
+        // read code from memory, the end of the code is not null terminated
+        const char code[] = "a \\\r\nb ; /* x */\rc ;\nd";
+        Settings settings;
+        Preprocessor preprocessor(&settings, this);
+        ASSERT_EQUALS("a b ;\n\nc ;\n", preprocessor.read(code, sizeof(code) - 2, "test.c", 0));
+    }
+
+    void mappedFile()
+    {
+        MappedFile file;
+        ASSERT_EQUALS(false, file.open("this-file-does-not-exist.cpp"));
+        ASSERT_EQUALS(false, file.isOpen());
+        ASSERT_EQUALS(0U, (unsigned int)file.size());
+    }
+
+    void headerCache()
+    {
+        Settings settings;
+        settings.addEnabled("missingInclude");
+        const std::list<std::string> includePaths;
+
+        {
+            std::ofstream fout("headercache.h");
+            fout << "int a; /* comment */\n";
+        }
+
+        // Headers are cached between files, missing headers are
+        // still reported each time
+        for (int i = 0; i < 2; ++i)
+        {
+            errout.str("");
+            std::istringstream istr("#include \"headercache.h\"\n#include \"headercache-missing.h\"\n");
+            std::string processedFile;
+            std::list<std::string> cfgs;
+            Preprocessor preprocessor(&settings, this);
+            preprocessor.preprocess(istr, processedFile, cfgs, "test.c", includePaths);
+            ASSERT_EQUALS("#file \"headercache.h\"\nint a;\n\n#endfile\n\n", processedFile);
+            ASSERT_EQUALS("[test.c:1]: (information) Include file: \"headercache-missing.h\" not found.\n", errout.str());
+        }
+
+        // A modified header is read again
+        {
+            std::ofstream fout("headercache.h");
+            fout << "int bb;\n";
+        }
+        {
+            std::istringstream istr("#include \"headercache.h\"\n");
+            std::string processedFile;
+            std::list<std::string> cfgs;
+            Preprocessor preprocessor(&settings, this);
+            preprocessor.preprocess(istr, processedFile, cfgs, "test.c", includePaths);
+            ASSERT_EQUALS("#file \"headercache.h\"\nint bb;\n\n#endfile\n", processedFile);
+        }
+
+        std::remove("headercache.h");
+    }
+
 
     void Bug2190219()
     {
@@ -1013,6 +1081,25 @@ private:
         }
     }
 
+    void match_cfg_def_many()
+    {
+        // More conditions than the cached results are simplified,
+        // the results must not change when the cache is cleared
+        std::map<std::string, std::string> cfg;
+        cfg["A"] = "5";
+        unsigned int matches = 0;
+        for (unsigned int i = 0; i < 10100; ++i)
+        {
+            std::ostringstream condition;
+            condition << "A==" << i;
+            if (Preprocessor::match_cfg_def(cfg, condition.str()))
+                ++matches;
+        }
+        ASSERT_EQUALS(1, matches);
+        ASSERT_EQUALS(true, Preprocessor::match_cfg_def(cfg, "A==5"));
+        ASSERT_EQUALS(false, Preprocessor::match_cfg_def(cfg, "A==10099"));
+    }
+
 
     void if_cond1()
     {
@@ -1454,6 +1541,19 @@ private:
         ASSERT_EQUALS("\na1;\n\n", Preprocessor::getcode(code, "Y", "test.c", NULL, NULL));
     }
 
+    void if_cached()
+    {
+        // The simplified conditions are cached. The same condition with
+        // other values must be simplified again.
+        const std::string code("#if X==1\n"
+                               "a1;\n"
+                               "#endif\n");
+        ASSERT_EQUALS("\na1;\n\n", Preprocessor::getcode(code, "X=1", "test.c", NULL, NULL));
+        ASSERT_EQUALS("\n\n\n", Preprocessor::getcode(code, "X=2", "test.c", NULL, NULL));
+        ASSERT_EQUALS("\n\n\n", Preprocessor::getcode(code, "Y=1", "test.c", NULL, NULL));
+        ASSERT_EQUALS("\na1;\n\n", Preprocessor::getcode(code, "X=1", "test.c", NULL, NULL));
+    }
+
 
     void multiline1()
     {
@@ -1692,6 +1792,31 @@ private:
         ASSERT_EQUALS("\n\"foo\"\n", OurPreprocessor::expandMacros(filedata));
     }
 
+    void macro_many()
+    {
+        // Many macros, every second macro is undefined
+        std::ostringstream code, expected;
+        for (int i = 0; i < 300; ++i)
+        {
+            code << "#define M" << i << "(x) x+" << i << "\n";
+            expected << "\n";
+        }
+        for (int i = 0; i < 300; i += 2)
+        {
+            code << "#undef M" << i << "\n";
+            expected << "\n";
+        }
+        for (int i = 0; i < 300; ++i)
+        {
+            code << "M" << i << "(a);\n";
+            if (i % 2)
+                expected << "a+" << i << ";\n";
+            else
+                expected << "M" << i << "(a);\n";
+        }
+        ASSERT_EQUALS(expected.str(), OurPreprocessor::expandMacros(code.str()));
+    }
+
     void macroInMacro()
     {
         {
@@ -0,0 +1,97 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "progress.h"
+#include "testsuite.h"
+
+#include <list>
+
+class TestProgress : public TestFixture
+{
+public:
+    TestProgress() : TestFixture("TestProgress")
+    { }
+
+private:
+
+    /** Records the reported progress */
+    class RecordingErrorLogger : public ErrorLogger
+    {
+    public:
+        std::list<std::string> reports;
+
+        void reportOut(const std::string &)
+        { }
+
+        void reportErr(const ErrorLogger::ErrorMessage &)
+        { }
+
+        void reportStatus(unsigned int, unsigned int)
+        { }
+
+        void reportProgress(const std::string &filename, const char stage[], const unsigned int value)
+        {
+            std::ostringstream ostr;
+            ostr << filename << ' ' << stage << ' ' << value;
+            reports.push_back(ostr.str());
+        }
+    };
+
+    void run()
+    {
+        TEST_CASE(report);
+        TEST_CASE(noReporter);
+    }
+
+    void report()
+    {
+        RecordingErrorLogger errorLogger;
+        ProgressReporter reporter(errorLogger);
+
+        // Report rarely so only the explicit reports are seen
+        ASSERT_EQUALS(true, reporter.start(60000));
+        {
+            Progress progress1("a.cpp", "Stage 1");
+            progress1.value(25);
+            Progress progress2("a.cpp", "Stage 2");
+            reporter.report();
+            progress2.value(50);
+        }
+        reporter.report();
+        reporter.stop();
+
+        ASSERT_EQUALS(2, static_cast<int>(errorLogger.reports.size()));
+        ASSERT_EQUALS("a.cpp Stage 1 25", errorLogger.reports.front());
+        ASSERT_EQUALS("a.cpp Stage 2 0", errorLogger.reports.back());
+    }
+
+    void noReporter()
+    {
+        RecordingErrorLogger errorLogger;
+        ProgressReporter reporter(errorLogger);
+
+        // Stages are not recorded when no reporter is running
+        Progress progress("a.cpp", "Stage");
+        ASSERT_EQUALS(true, reporter.start(60000));
+        reporter.report();
+        reporter.stop();
+        ASSERT_EQUALS(0, static_cast<int>(errorLogger.reports.size()));
+    }
+};
+
+REGISTER_TEST(TestProgress)
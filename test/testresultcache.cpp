@@ -0,0 +1,173 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "resultcache.h"
+#include "settings.h"
+#include "testsuite.h"
+
+#include <cstdio>
+#include <fstream>
+
+class TestResultCache : public TestFixture
+{
+public:
+    TestResultCache() : TestFixture("TestResultCache")
+    { }
+
+private:
+
+    void run()
+    {
+        TEST_CASE(key);
+        TEST_CASE(saveLoad);
+        TEST_CASE(loadMissing);
+        TEST_CASE(saveWhileReading);
+        TEST_CASE(saveLoadUsage);
+        TEST_CASE(saveLoadAnalysis);
+    }
+
+    void key()
+    {
+        Settings settings;
+        std::list<std::string> configurations;
+        configurations.push_back("");
+        const std::string key1(ResultCache::key(settings, "a.cpp", "int x;\n", configurations));
+        ASSERT_EQUALS(16, key1.size());
+        ASSERT_EQUALS(key1, ResultCache::key(settings, "a.cpp", "int x;\n", configurations));
+
+        // Everything the results depend on must change the key
+        ASSERT(key1 != ResultCache::key(settings, "b.cpp", "int x;\n", configurations));
+        ASSERT(key1 != ResultCache::key(settings, "a.cpp", "int y;\n", configurations));
+
+        std::list<std::string> configurations2(configurations);
+        configurations2.push_back("A");
+        ASSERT(key1 != ResultCache::key(settings, "a.cpp", "int x;\n", configurations2));
+
+        Settings settings2;
+        settings2._checkCodingStyle = true;
+        ASSERT(key1 != ResultCache::key(settings2, "a.cpp", "int x;\n", configurations));
+    }
+
+    void saveLoad()
+    {
+        ErrorLogger::ErrorMessage::FileLocation loc;
+        loc.setfile("a.cpp");
+        loc.line = 4;
+        std::list<ErrorLogger::ErrorMessage::FileLocation> locs;
+        locs.push_back(loc);
+
+        std::list<ResultCache::Result> results;
+        results.push_back(ResultCache::Result(false, ErrorLogger::ErrorMessage(locs, Severity::error, "Memory leak: p", "memleak")));
+        results.push_back(ResultCache::Result(true, ErrorLogger::ErrorMessage(std::list<ErrorLogger::ErrorMessage::FileLocation>(), Severity::information, "Too many configurations", "toomanyconfigs")));
+
+        const ResultCache cache(".");
+        cache.save("0123456789abcdef", "a.cpp", results);
+
+        std::list<ResultCache::Result> loaded;
+        ASSERT_EQUALS(true, cache.load("0123456789abcdef", "a.cpp", loaded));
+        ASSERT_EQUALS(2, loaded.size());
+        if (loaded.size() == 2)
+        {
+            ASSERT_EQUALS(false, loaded.front()._direct);
+            ASSERT_EQUALS(results.front()._msg.serialize(), loaded.front()._msg.serialize());
+            ASSERT_EQUALS(true, loaded.back()._direct);
+            ASSERT_EQUALS(results.back()._msg.serialize(), loaded.back()._msg.serialize());
+        }
+
+        // The file name is saved and compared
+        loaded.clear();
+        ASSERT_EQUALS(false, cache.load("0123456789abcdef", "b.cpp", loaded));
+
+        std::remove("./0123456789abcdef.results");
+    }
+
+    void loadMissing()
+    {
+        const ResultCache cache(".");
+        std::list<ResultCache::Result> loaded;
+        ASSERT_EQUALS(false, cache.load("fedcba9876543210", "a.cpp", loaded));
+        ASSERT_EQUALS(0, loaded.size());
+    }
+
+    void saveWhileReading()
+    {
+        const ResultCache cache(".");
+        cache.save("0123456789abcdef", "a.cpp", std::list<ResultCache::Result>());
+
+        // The file is replaced, not overwritten, so a reader still
+        // sees the complete old file
+        std::ifstream fin("./0123456789abcdef.results", std::ios::in | std::ios::binary);
+        ASSERT_EQUALS(true, fin.is_open());
+        cache.save("0123456789abcdef", "b.cpp", std::list<ResultCache::Result>());
+
+        std::string line;
+        ASSERT_EQUALS(true, bool(std::getline(fin, line)));
+        ASSERT_EQUALS("cppcheck results", line);
+        ASSERT_EQUALS(true, bool(std::getline(fin, line)));
+        ASSERT_EQUALS("a.cpp", line);
+        fin.close();
+
+        std::remove("./0123456789abcdef.results");
+    }
+
+    void saveLoadUsage()
+    {
+        std::list<CheckUnusedFunctions::Summary> usage(1);
+        usage.front().filename = "a.cpp";
+        usage.front().defined.push_back("f");
+        usage.front().used.push_back("g");
+
+        const ResultCache cache(".");
+        cache.save("0123456789abcdef", "a.cpp", std::list<ResultCache::Result>(), &usage);
+
+        std::list<ResultCache::Result> loaded;
+        std::list<CheckUnusedFunctions::Summary> loadedUsage;
+        ASSERT_EQUALS(true, cache.load("0123456789abcdef", "a.cpp", loaded, &loadedUsage));
+        ASSERT_EQUALS(CheckUnusedFunctions::serialize(usage), CheckUnusedFunctions::serialize(loadedUsage));
+
+        // Results that were saved without the functions can't be used
+        // when the functions are needed
+        cache.save("0123456789abcdef", "a.cpp", std::list<ResultCache::Result>());
+        loadedUsage.clear();
+        ASSERT_EQUALS(true, cache.load("0123456789abcdef", "a.cpp", loaded));
+        ASSERT_EQUALS(false, cache.load("0123456789abcdef", "a.cpp", loaded, &loadedUsage));
+        ASSERT_EQUALS(0, loadedUsage.size());
+
+        std::remove("./0123456789abcdef.results");
+    }
+
+    void saveLoadAnalysis()
+    {
+        std::set<std::string> data;
+        data.insert("f");
+        data.insert("with space");
+
+        const ResultCache cache(".");
+        cache.saveAnalysis("0123456789abcdef", "a.cpp", data);
+
+        std::set<std::string> loaded;
+        ASSERT_EQUALS(true, cache.loadAnalysis("0123456789abcdef", "a.cpp", loaded));
+        ASSERT_EQUALS(true, data == loaded);
+        ASSERT_EQUALS(false, cache.loadAnalysis("0123456789abcdef", "b.cpp", loaded));
+        ASSERT_EQUALS(false, cache.loadAnalysis("fedcba9876543210", "a.cpp", loaded));
+
+        std::remove("./0123456789abcdef.analysis");
+    }
+};
+
+REGISTER_TEST(TestResultCache)
@@ -37,6 +37,7 @@ private:
         TEST_CASE(suppressionsDosFormat);     // Ticket #1836
         TEST_CASE(suppressionsFileNameWithColon);    // Ticket #1919 - filename includes colon
         TEST_CASE(suppressionsGlob);
+        TEST_CASE(suppressionsGlobMatchesSaved);
     }
 
     void suppressionsBadId1()
@@ -99,6 +100,49 @@ private:
             ASSERT_EQUALS(true, suppressions.isSuppressed("errorid", "abc.cpp", 2));
         }
     }
+
+    void suppressionsGlobMatchesSaved()
+    {
+        // The globs that match a file are saved, a glob that is added later must still apply
+        {
+            Settings::Suppressions suppressions;
+            ASSERT_EQUALS("", suppressions.addSuppression("errorid", "x*.cpp", 1));
+            ASSERT_EQUALS(true, suppressions.isSuppressed("errorid", "xyz.cpp", 1));
+            ASSERT_EQUALS(false, suppressions.isSuppressed("errorid", "xyz.cpp", 2));
+            ASSERT_EQUALS("", suppressions.addSuppression("errorid", "*z.cpp", 2));
+            ASSERT_EQUALS(true, suppressions.isSuppressed("errorid", "xyz.cpp", 2));
+            ASSERT_EQUALS(false, suppressions.isSuppressed("errorid", "abc.cpp", 2));
+            ASSERT_EQUALS(0, suppressions.getUnmatchedGlobalSuppressions().size());
+        }
+
+        // The saved matches are cleared when there are many files
+        {
+            Settings::Suppressions suppressions;
+            ASSERT_EQUALS("", suppressions.addSuppression("errorid", "x*.cpp"));
+            bool suppressed = true;
+            for (unsigned int i = 0; i < 2500; ++i)
+            {
+                std::ostringstream name;
+                name << (i % 2 ? "x" : "y") << i << ".cpp";
+                suppressed &= (suppressions.isSuppressed("errorid", name.str(), 1) == bool(i % 2));
+            }
+            ASSERT_EQUALS(true, suppressed);
+            ASSERT_EQUALS(true, suppressions.isSuppressed("errorid", "x1.cpp", 1));
+            ASSERT_EQUALS(false, suppressions.isSuppressed("errorid", "y0.cpp", 1));
+        }
+
+        // A copy matches against its own globs
+        {
+            Settings settings;
+            ASSERT_EQUALS("", settings.nomsg.addSuppression("errorid", "x*.cpp"));
+            ASSERT_EQUALS(true, settings.nomsg.isSuppressed("errorid", "xyz.cpp", 1));
+
+            Settings copy(settings);
+            settings.nomsg = Settings::Suppressions();
+            ASSERT_EQUALS(true, copy.nomsg.isSuppressed("errorid", "xyz.cpp", 1));
+            ASSERT_EQUALS(false, settings.nomsg.isSuppressed("errorid", "xyz.cpp", 1));
+        }
+    }
 };
 
 REGISTER_TEST(TestSettings)
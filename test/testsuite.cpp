@@ -65,8 +65,9 @@ unsigned int       TestFixture::countTests;
 size_t TestFixture::fails_counter = 0;
 size_t TestFixture::todos_counter = 0;
 
-TestFixture::TestFixture(const std::string &_name)
-    :classname(_name)
+TestFixture::TestFixture(const std::string &_name, bool _optIn)
+    :optIn(_optIn)
+    ,classname(_name)
     ,gcc_style_errors(false)
     ,quiet_tests(false)
 {
@@ -259,7 +260,7 @@ size_t TestFixture::runTests(const options& args)
 
     for (std::list<TestFixture *>::const_iterator it = tests.begin(); it != tests.end(); ++it)
     {
-        if (classname.empty() || (*it)->classname == classname)
+        if ((classname.empty() && !(*it)->optIn) || (*it)->classname == classname)
         {
             (*it)->processOptions(args);
             (*it)->run(testname);
@@ -36,6 +36,9 @@ private:
     static size_t fails_counter;
     static size_t todos_counter;
 
+    /** Run only when selected on the command line, e.g. benchmarks */
+    bool optIn;
+
 protected:
     std::string classname;
     std::string testToRun;
@@ -64,7 +67,11 @@ public:
     virtual void reportStatus(unsigned int /*index*/, unsigned int /*max*/) {}
     void run(const std::string &str);
 
-    TestFixture(const std::string &_name);
+    /**
+     * @param _name name of the fixture
+     * @param _optIn run the fixture only when it is selected on the command line
+     */
+    TestFixture(const std::string &_name, bool _optIn = false);
     virtual ~TestFixture() { }
 
     static void printTests();
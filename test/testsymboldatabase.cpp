@@ -100,6 +100,9 @@ private:
         TEST_CASE(hasGlobalVariables1);
         TEST_CASE(hasGlobalVariables2);
         TEST_CASE(hasGlobalVariables3);
+
+        TEST_CASE(rebuiltForNewTokensVersion);
+        TEST_CASE(indexedLookups);
     }
 
     void test_isVariableDeclarationCanHandleNull()
@@ -604,6 +607,161 @@ private:
             }
         }
     }
+
+    void rebuiltForNewTokensVersion()
+    {
+        GET_SYMBOL_DB("void f() { int a = 0; if (a) { a++; } }\n")
+
+        // the database is shared until the tokens change
+        const unsigned int version = tokenizer.tokensVersion();
+        ASSERT(db == tokenizer.getSymbolDatabase());
+        ASSERT(db && db->scopeList.size() == 3);
+
+        // simplifying the tokens starts a new version and the database
+        // is built again from the simplified tokens
+        tokenizer.simplifyTokenList();
+        ASSERT(version != tokenizer.tokensVersion());
+        db = tokenizer.getSymbolDatabase();
+        ASSERT(db && db->scopeList.size() == 2);
+
+        std::set<const Token *> tokens;
+        for (const Token *tok = tokenizer.tokens(); tok; tok = tok->next())
+            tokens.insert(tok);
+        bool current = true;
+        std::list<Scope *>::const_iterator it;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            if ((*it)->classStart)
+                current &= (tokens.find((*it)->classStart) != tokens.end());
+        }
+        ASSERT_EQUALS(true, current);
+
+        // the database records its version, a new version builds it again
+        ASSERT_EQUALS(tokenizer.tokensVersion(), db->tokensVersion());
+        tokenizer.newTokensVersion();
+        ASSERT_EQUALS(tokenizer.tokensVersion(), tokenizer.getSymbolDatabase()->tokensVersion());
+    }
+
+    /**
+     * Generate many classes, like the protocol code that code generators create.
+     * @param classes number of generated classes
+     */
+    static std::string manyClasses(unsigned int classes)
+    {
+        std::ostringstream code;
+        code << "namespace proto {\n";
+        for (unsigned int i = 0; i < classes; ++i)
+        {
+            code << "class Msg" << i << "\n"
+                 << "{\n"
+                 << "public:\n"
+                 << "    Msg" << i << "();\n"
+                 << "    int get() const;\n"
+                 << "    void set(int v);\n"
+                 << "private:\n"
+                 << "    int value;\n";
+            if (i > 0)
+                code << "    Msg" << (i - 1) << " *prev;\n";
+            code << "};\n"
+                 << "Msg" << i << "::Msg" << i << "() : value(0) { }\n"
+                 << "int Msg" << i << "::get() const { return value; }\n"
+                 << "void Msg" << i << "::set(int v) { value = v; }\n"
+                 << "void handle" << i << "(Msg" << i << " &m) { m.set(" << i << "); }\n";
+        }
+        code << "}\n";
+        return code.str();
+    }
+
+    /** The linear scan over scopeList that findVariableType used to do */
+    static const Scope *findVariableTypeScan(const SymbolDatabase *db, const Scope *start, const Token *type)
+    {
+        std::list<Scope *>::const_iterator it;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            const Scope *scope = *it;
+            if (scope->type == Scope::eNamespace || scope->type == Scope::eFunction || scope->type == Scope::eGlobal)
+                continue;
+            if (scope->className == type->str())
+            {
+                if (type->previous()->str() != "::")
+                {
+                    const Scope *parent = start;
+                    while (parent && parent != scope->nestedIn)
+                        parent = parent->nestedIn;
+                    if (scope->nestedIn == parent)
+                        return scope;
+                }
+                else
+                    return scope;
+            }
+        }
+        return NULL;
+    }
+
+    /** The linear scan over scopeList that findFunctionScopeByName replaces */
+    static const Scope *findFunctionScopeScan(const SymbolDatabase *db, const std::string &name)
+    {
+        std::list<Scope *>::const_iterator it;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            if ((*it)->type == Scope::eFunction && (*it)->className == name)
+                return *it;
+        }
+        return NULL;
+    }
+
+    void indexedLookups()
+    {
+        GET_SYMBOL_DB(manyClasses(50))
+
+        // every function must have been matched with its class
+        std::list<Scope *>::const_iterator it;
+        unsigned int functions = 0;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            if ((*it)->type == Scope::eFunction && (*it)->functionOf)
+                ++functions;
+        }
+        ASSERT_EQUALS(3 * 50U, functions);
+
+        // look up the type of every variable declaration, in the scope it is in
+        std::vector<std::pair<const Scope *, const Token *> > lookups;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            if (!(*it)->classStart)
+                continue;
+            for (const Token *tok = (*it)->classStart; tok != (*it)->classEnd; tok = tok->next())
+            {
+                if (Token::Match(tok, "%type% *|&| %var% [;,)]"))
+                    lookups.push_back(std::make_pair(*it, tok));
+            }
+        }
+
+        std::vector<const Scope *> expected;
+        for (unsigned int i = 0; i < lookups.size(); ++i)
+            expected.push_back(findVariableTypeScan(db, lookups[i].first, lookups[i].second));
+
+        std::vector<const Scope *> actual;
+        for (unsigned int i = 0; i < lookups.size(); ++i)
+            actual.push_back(db->findVariableType(lookups[i].first, lookups[i].second));
+
+        ASSERT(expected == actual);
+
+        // look up every function by name and by token
+        bool same = true;
+        for (it = db->scopeList.begin(); it != db->scopeList.end(); ++it)
+        {
+            if ((*it)->type == Scope::eFunction)
+            {
+                same &= (db->findFunctionScopeByToken((*it)->classDef) == *it);
+                same &= (tokenizer.getFunctionTokenByName((*it)->className.c_str()) == findFunctionScopeScan(db, (*it)->className)->classDef);
+            }
+            std::list<Function>::const_iterator func;
+            for (func = (*it)->functionList.begin(); func != (*it)->functionList.end(); ++func)
+                same &= (db->findFunctionByToken(func->token) == &*func);
+        }
+        ASSERT_EQUALS(true, same);
+    }
 };
 
 REGISTER_TEST(TestSymbolDatabase)
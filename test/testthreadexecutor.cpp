@@ -45,7 +45,7 @@ private:
      * Execute check using n jobs for y files which are have
      * identical data, given within data.
      */
-    void check(unsigned int jobs, int files, int result, const std::string &data)
+    void check(unsigned int jobs, int files, int result, const std::string &data, bool processes = false)
     {
         errout.str("");
         output.str("");
@@ -65,6 +65,7 @@ private:
 
         Settings settings;
         settings._jobs = jobs;
+        settings._processExecutor = processes;
         ThreadExecutor executor(filenames, settings, *this);
         for (unsigned int i = 0; i < filenames.size(); ++i)
             executor.addFileContent(filenames[i], data);
@@ -80,6 +81,10 @@ private:
         TEST_CASE(no_errors_equal_amount_files);
         TEST_CASE(one_error_less_files);
         TEST_CASE(one_error_several_files);
+        TEST_CASE(more_jobs_than_files);
+        TEST_CASE(processes);
+        TEST_CASE(configurations);
+        TEST_CASE(unusedFunctions);
     }
 
     void deadlock_with_many_errors()
@@ -140,6 +145,89 @@ private:
         oss << "}\n";
         check(2, 20, 20, oss.str());
     }
+
+    void more_jobs_than_files()
+    {
+        std::ostringstream oss;
+        oss << "int main()\n"
+            << "{\n";
+        oss << "  {char *a = malloc(10);}\n";
+        oss << "}\n";
+        check(8, 3, 3, oss.str());
+    }
+
+    void processes()
+    {
+        if (!ThreadExecutor::processesEnabled())
+            return;
+
+        std::ostringstream oss;
+        oss << "int main()\n"
+            << "{\n";
+        oss << "  {char *a = malloc(10);}\n";
+        oss << "}\n";
+        check(2, 3, 3, oss.str(), true);
+    }
+
+    void configurations()
+    {
+        // The configurations of the file are checked by the spare jobs
+        std::ostringstream oss;
+        for (int i = 0; i < 8; i++)
+        {
+            oss << "#ifdef A" << i << "\n"
+                << "void f" << i << "()\n"
+                << "{\n"
+                << "  char *a = malloc(10);\n"
+                << "}\n"
+                << "#endif\n";
+        }
+        check(4, 1, 1, oss.str());
+
+        // Each configuration has a memory leak
+        const std::string errors(errout.str());
+        unsigned int count = 0;
+        for (std::string::size_type pos = errors.find("Memory leak"); pos != std::string::npos; pos = errors.find("Memory leak", pos + 1))
+            ++count;
+        ASSERT_EQUALS(8, count);
+    }
+
+    /** Check files with unusedFunctions enabled, the files are merged by the executor */
+    void checkUnusedFunctions(unsigned int jobs, bool processes, bool test2pass)
+    {
+        errout.str("");
+        output.str("");
+
+        std::vector<std::string> filenames;
+        filenames.push_back("b.cpp");
+        filenames.push_back("a.cpp");
+
+        Settings settings;
+        settings._jobs = jobs;
+        settings._processExecutor = processes;
+        settings.test_2_pass = test2pass;
+        settings.addEnabled("unusedFunction");
+        ThreadExecutor executor(filenames, settings, *this);
+        executor.addFileContent("a.cpp", "void f() { }\nvoid g() { f(); }\n");
+        executor.addFileContent("b.cpp", "void h() { g(); }\n");
+
+        ASSERT_EQUALS(1, executor.check());
+    }
+
+    void unusedFunctions()
+    {
+        checkUnusedFunctions(2, false, false);
+        ASSERT_EQUALS("[b.cpp:1]: (style) The function 'h' is never used\n", errout.str());
+
+        checkUnusedFunctions(2, false, true);
+        ASSERT_EQUALS("[b.cpp:1]: (style) The function 'h' is never used\n", errout.str());
+
+        if (ThreadExecutor::processesEnabled())
+        {
+            checkUnusedFunctions(2, true, false);
+            ASSERT_EQUALS("[b.cpp:1]: (style) The function 'h' is never used\n", errout.str());
+        }
+    }
 };
 
 REGISTER_TEST(TestThreadExecutor)
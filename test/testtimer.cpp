@@ -0,0 +1,129 @@
+/*
+ * Cppcheck - A tool for static C/C++ code analysis
+ * Copyright (C) 2007-2011 Daniel Marjamäki and Cppcheck team.
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "timer.h"
+#include "testsuite.h"
+
+#include <list>
+
+class TestTimer : public TestFixture
+{
+public:
+    TestTimer() : TestFixture("TestTimer")
+    { }
+
+private:
+
+    /** Records the results of the timers */
+    class RecordingTimerResults : public TimerResultsIntf
+    {
+    public:
+        std::list<std::string> names;
+        std::list<unsigned long long> nanoseconds;
+        std::list<unsigned long long> childNanoseconds;
+
+        void AddResults(const std::string& str, unsigned long long ns, unsigned long long childNs)
+        {
+            names.push_back(str);
+            nanoseconds.push_back(ns);
+            childNanoseconds.push_back(childNs);
+        }
+    };
+
+    void run()
+    {
+        TEST_CASE(nested);
+        TEST_CASE(otherThread);
+        TEST_CASE(none);
+        TEST_CASE(serialize);
+    }
+
+    void nested()
+    {
+        RecordingTimerResults results;
+        {
+            Timer outer("outer", SHOWTIME_SUMMARY, &results);
+            Timer inner1("inner1", SHOWTIME_SUMMARY);
+            inner1.Stop();
+            Timer inner2("inner2", SHOWTIME_SUMMARY);
+            ASSERT_EQUALS(true, Timer::current() == &inner2);
+        }
+        ASSERT_EQUALS(true, Timer::current() == NULL);
+
+        ASSERT_EQUALS(3, static_cast<int>(results.names.size()));
+        ASSERT_EQUALS("outer > inner1", results.names.front());
+        results.names.pop_front();
+        ASSERT_EQUALS("outer > inner2", results.names.front());
+        ASSERT_EQUALS("outer", results.names.back());
+
+        // The time of the nested timers is the child time of the outer timer
+        ASSERT_EQUALS(true, results.childNanoseconds.back() <= results.nanoseconds.back());
+        ASSERT_EQUALS(true, results.childNanoseconds.back() >= results.nanoseconds.front());
+    }
+
+    void otherThread()
+    {
+        RecordingTimerResults results;
+        Timer parent("parent", SHOWTIME_SUMMARY, &results);
+        parent.Stop();
+        {
+            // The parent is not the current timer (it could run in another
+            // thread) so its time is not changed
+            Timer child("child", SHOWTIME_SUMMARY, NULL, &parent);
+            Timer child2("child2", SHOWTIME_SUMMARY);
+        }
+        ASSERT_EQUALS(true, Timer::current() == NULL);
+
+        ASSERT_EQUALS(3, static_cast<int>(results.names.size()));
+        ASSERT_EQUALS("parent", results.names.front());
+        ASSERT_EQUALS(0, static_cast<int>(results.childNanoseconds.front()));
+        results.names.pop_front();
+        ASSERT_EQUALS("parent > child > child2", results.names.front());
+        ASSERT_EQUALS("parent > child", results.names.back());
+    }
+
+    void none()
+    {
+        RecordingTimerResults results;
+        {
+            Timer timer("timer", SHOWTIME_NONE, &results);
+            ASSERT_EQUALS(true, Timer::current() == NULL);
+        }
+        ASSERT_EQUALS(0, static_cast<int>(results.names.size()));
+    }
+
+    void serialize()
+    {
+        TimerResults results1;
+        results1.AddResults("a > b", 2000, 1000);
+        results1.AddResults("a > b", 3000, 0);
+        results1.AddResults("c", 5, 0);
+        const std::string data(results1.serialize());
+        ASSERT_EQUALS("5000 1000 2 a > b\n5 0 1 c\n", data);
+
+        TimerResults results2;
+        results2.merge(data);
+        results2.merge(data);
+        ASSERT_EQUALS("10000 2000 4 a > b\n10 0 2 c\n", results2.serialize());
+
+        results2.clear();
+        ASSERT_EQUALS("", results2.serialize());
+    }
+};
+
+REGISTER_TEST(TestTimer)
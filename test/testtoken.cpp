@@ -20,8 +20,12 @@
 #include "testutils.h"
 #include "token.h"
 #include "settings.h"
+#include "threading.h"
 
 #include <cstring>
+#include <sstream>
+#include <string>
+#include <vector>
 
 extern std::ostringstream errout;
 class TestToken : public TestFixture
@@ -38,14 +42,22 @@ private:
         TEST_CASE(multiCompare);
         TEST_CASE(getStrLength);
         TEST_CASE(strValue);
+        TEST_CASE(sharedStr);
+        TEST_CASE(kinds);
 
         TEST_CASE(deleteLast);
+        TEST_CASE(pool);
 
         TEST_CASE(matchAny);
         TEST_CASE(matchNothingOrAnyNotElse);
         TEST_CASE(matchNumeric);
         TEST_CASE(matchBoolean);
         TEST_CASE(matchOr);
+        TEST_CASE(matchCharSet);
+        TEST_CASE(matchChangedPattern);
+        TEST_CASE(matchManyPatterns);
+        TEST_CASE(strId);
+        TEST_CASE(matchOtherThread);
     }
 
     void nextprevious()
@@ -118,6 +130,57 @@ private:
         ASSERT_EQUALS(std::string("0"), tok.strValue());
     }
 
+    void sharedStr()
+    {
+        Token *token = new Token(0);
+        token->str("abc");
+        token->insertToken("abc");
+        ASSERT_EQUALS(true, &token->str() == &token->next()->str());
+
+        // concatenated strings are shared too
+        token->str("\"ab\"");
+        token->next()->str("\"a\"");
+        token->next()->concatStr("\"b\"");
+        ASSERT_EQUALS("\"ab\"", token->next()->str());
+        ASSERT_EQUALS(true, &token->str() == &token->next()->str());
+        ASSERT_EQUALS(true, Token::Match(token, "\"ab\" \"ab\""));
+
+        Tokenizer::deleteTokens(token);
+    }
+
+    void kinds()
+    {
+        Token tok(0);
+
+        tok.str("int");
+        ASSERT_EQUALS(true, tok.isKeyword());
+        ASSERT_EQUALS(true, tok.isStandardType());
+
+        tok.str("size_t");
+        ASSERT_EQUALS(false, tok.isKeyword());
+        ASSERT_EQUALS(true, tok.isStandardType());
+
+        tok.str("x");
+        ASSERT_EQUALS(false, tok.isKind(~0U));
+
+        tok.str("\"abc\"");
+        ASSERT_EQUALS(true, tok.isString());
+        ASSERT_EQUALS(false, tok.isChar());
+
+        tok.str("'a'");
+        ASSERT_EQUALS(true, tok.isChar());
+
+        tok.str("<<=");
+        ASSERT_EQUALS(true, tok.isAssignmentOp());
+
+        tok.str("<<");
+        ASSERT_EQUALS(true, tok.isKind(Token::eArithmeticalOp));
+
+        tok.str("{");
+        ASSERT_EQUALS(true, tok.isKind(Token::eBracket));
+        ASSERT_EQUALS(false, tok.isKind(Token::eLogicalOp | Token::eBitOp));
+    }
+
 
     void deleteLast()
     {
@@ -129,6 +192,33 @@ private:
         ASSERT_EQUALS(true, tokensBack == &tok);
     }
 
+    void pool()
+    {
+        // More tokens than one block of the pool has
+        TokenPool pool;
+        Token *tokensBack = 0;
+        Token *token = new (pool) Token(&tokensBack, &pool);
+        tokensBack = token;
+        token->str("0");
+        for (unsigned int i = 1; i < 3000; ++i)
+        {
+            std::ostringstream str;
+            str << i;
+            tokensBack->insertToken(str.str());
+        }
+        ASSERT_EQUALS("2999", tokensBack->str());
+        ASSERT_EQUALS("1500", token->tokAt(1500)->str());
+
+        // Deleted tokens are reused
+        token->deleteNext();
+        token->insertToken("x");
+        ASSERT_EQUALS("x", token->next()->str());
+        ASSERT_EQUALS("2", token->tokAt(2)->str());
+
+        // The tokens must be deleted before the pool
+        Tokenizer::deleteTokens(token);
+    }
+
 
     void matchAny()
     {
@@ -222,6 +312,118 @@ private:
         ASSERT_EQUALS(false, Token::Match(logicalOr.tokens(), "%or%"));
         ASSERT_EQUALS(false, Token::Match(bitwiseOr.tokens(), "%oror%"));
     }
+
+    void matchCharSet()
+    {
+        givenACodeSampleToTokenize semicolon(";");
+        ASSERT_EQUALS(true, Token::Match(semicolon.tokens(), "[;{}]"));
+        ASSERT_EQUALS(false, Token::Match(semicolon.tokens(), "[{}]"));
+
+        givenACodeSampleToTokenize bracket("]");
+        ASSERT_EQUALS(true, Token::Match(bracket.tokens(), "[;]]"));
+        ASSERT_EQUALS(false, Token::Match(bracket.tokens(), "[;]"));
+
+        givenACodeSampleToTokenize longToken("abc");
+        ASSERT_EQUALS(false, Token::Match(longToken.tokens(), "[abc]"));
+    }
+
+    void matchChangedPattern()
+    {
+        // Compiled patterns are cached by address. A pattern that is
+        // changed at the same address must be compiled again.
+        givenACodeSampleToTokenize code("x = 1 ;");
+        char pattern[20];
+        std::strcpy(pattern, "%var% = %num%");
+        ASSERT_EQUALS(true, Token::Match(code.tokens(), pattern));
+        std::strcpy(pattern, "%var% = %str%");
+        ASSERT_EQUALS(false, Token::Match(code.tokens(), pattern));
+        std::strcpy(pattern, "x|y = 1|2 !!;");
+        ASSERT_EQUALS(false, Token::Match(code.tokens(), pattern));
+        std::strcpy(pattern, "x|y = 1|2 ;");
+        ASSERT_EQUALS(true, Token::Match(code.tokens(), pattern));
+    }
+
+    void matchManyPatterns()
+    {
+        // The cache of compiled patterns is cleared when it is half
+        // full. Patterns that were compiled before are compiled again.
+        givenACodeSampleToTokenize code("x = 1 ;");
+        std::vector<std::string> patterns;
+        for (unsigned int i = 0; i < 10000; ++i)
+        {
+            std::ostringstream pattern;
+            pattern << "x = " << i << " ;";
+            patterns.push_back(pattern.str());
+        }
+
+        unsigned int matches = 0;
+        for (unsigned int round = 0; round < 2; ++round)
+        {
+            for (std::vector<std::string>::const_iterator it = patterns.begin(); it != patterns.end(); ++it)
+            {
+                if (Token::Match(code.tokens(), it->c_str()))
+                    ++matches;
+            }
+        }
+        ASSERT_EQUALS(2, matches);
+        ASSERT_EQUALS(true, Token::Match(code.tokens(), patterns[1].c_str()));
+        ASSERT_EQUALS(false, Token::Match(code.tokens(), patterns[2].c_str()));
+    }
+
+    void strId()
+    {
+        Token *token = new Token(0);
+        ASSERT_EQUALS(true, token->strId() != 0);
+        token->str("if");
+        token->insertToken("(");
+        token->next()->insertToken("abc");
+        ASSERT_EQUALS(true, token->strId() != 0);
+        ASSERT_EQUALS(true, token->next()->strId() != 0);
+        ASSERT_EQUALS(true, token->strId() != token->next()->strId());
+        ASSERT_EQUALS(0, token->tokAt(2)->strId());
+
+        const unsigned int ifId = token->strId();
+        token->deleteThis();
+        ASSERT_EQUALS("(", token->str());
+        token->str("if");
+        ASSERT_EQUALS(ifId, token->strId());
+
+        Tokenizer::deleteTokens(token);
+    }
+
+    /** Create tokens "abc ( x )" in another thread */
+    static void createTokens(void *arg)
+    {
+        Token *token = new Token(0);
+        token->str("abc");
+        token->insertToken("(");
+        token->next()->insertToken("x");
+        token->tokAt(2)->insertToken(")");
+        *static_cast<Token **>(arg) = token;
+    }
+
+    void matchOtherThread()
+    {
+        // The strings of the tokens are from the table of the other
+        // thread, the words of the patterns are from this thread
+        Token *token = 0;
+        {
+            Thread thread;
+            ASSERT_EQUALS(true, thread.start(createTokens, &token));
+        }
+        ASSERT_EQUALS(true, token != 0);
+        if (!token)
+            return;
+
+        ASSERT_EQUALS(true, Token::Match(token, "abc ( x )"));
+        ASSERT_EQUALS(true, Token::Match(token, "strcpy|abc ( %var% )"));
+        ASSERT_EQUALS(false, Token::Match(token, "abd ( x )"));
+        ASSERT_EQUALS(false, Token::Match(token, "abc ( y )"));
+        ASSERT_EQUALS(true, Token::Match(token, "abc !!abd x !!y"));
+
+        // The tokens are deleted by this thread
+        Tokenizer::deleteTokens(token);
+    }
 };
 
 REGISTER_TEST(TestToken)
@@ -191,6 +191,7 @@ private:
         TEST_CASE(varidclass7);
         TEST_CASE(varidclass8);
         TEST_CASE(varidclass9);
+        TEST_CASE(varidScopeIndex);
 
         TEST_CASE(file1);
         TEST_CASE(file2);
@@ -315,6 +316,8 @@ private:
 
         // Some simple cleanups of unhandled macros in the global scope
         TEST_CASE(removeMacrosInGlobalScope);
+
+        TEST_CASE(bodies);
     }
 
 
@@ -3390,6 +3393,38 @@ private:
         ASSERT_EQUALS(expected, tokenizeDebugListing(code));
     }
 
+    void varidScopeIndex()
+    {
+        // The scope index and the scope walk must give the same variable ids
+        std::ostringstream code;
+        code << "struct S { int x; };\n"
+             << "int f(int a, struct S *s)\n"
+             << "{\n"
+             << "    int sum = 0;\n";
+        for (unsigned int i = 0; i < 20; ++i)
+        {
+            code << "    int v" << i << " = a + " << i << ";\n"
+                 << "    for (int i = 0; i < v" << i << "; i++)\n"
+                 << "    {\n"
+                 << "        int x = i * v" << (i / 2) << ";\n"
+                 << "        sum += x + s->x;\n"
+                 << "    }\n";
+        }
+        code << "    return sum;\n"
+             << "}\n";
+
+        errout.str("");
+        Settings settings;
+        Tokenizer tokenizer(&settings, this);
+        std::istringstream istr(code.str());
+        tokenizer.tokenize(istr, "test.cpp");
+
+        tokenizer.setVarId(false);
+        const std::string expected(tokenizer.tokens()->stringifyList(true));
+        tokenizer.setVarId(true);
+        ASSERT_EQUALS(expected, tokenizer.tokens()->stringifyList(true));
+    }
+
 
     void file1()
     {
@@ -5447,6 +5482,29 @@ private:
         // remove some unhandled macros in the global scope.
         ASSERT_EQUALS("void f ( ) { }", tokenizeAndStringify("void f() NOTHROW { }"));
     }
+
+    void bodies()
+    {
+        errout.str("");
+        Settings settings;
+        Tokenizer tokenizer(&settings, this);
+        std::istringstream istr("void f() { if (x) { } }\n"
+                                "void g() const { }");
+        tokenizer.tokenize(istr, "test.cpp");
+
+        const std::vector<const Token *> &bodies = tokenizer.getBodies();
+        ASSERT_EQUALS(3, static_cast<int>(bodies.size()));
+        if (bodies.size() == 3)
+        {
+            ASSERT_EQUALS(1U, bodies[0]->linenr());
+            ASSERT_EQUALS("if", bodies[1]->previous()->link()->previous()->str());
+            ASSERT_EQUALS(2U, bodies[2]->linenr());
+        }
+
+        // rebuilt when the token list changes
+        tokenizer.simplifyTokenList();
+        ASSERT_EQUALS(3, static_cast<int>(tokenizer.getBodies().size()));
+    }
 };
 
 REGISTER_TEST(TestTokenizer)
@@ -47,6 +47,8 @@ private:
         TEST_CASE(initializationIsNotAFunction);
 
         TEST_CASE(multipleFiles);   // same function name in multiple files
+
+        TEST_CASE(summaries);       // merge serialized summaries of several files (-j)
     }
 
     void check(const char code[])
@@ -216,6 +218,41 @@ private:
 
         ASSERT_EQUALS("[test1.cpp:1]: (style) The function 'f' is never used\n",errout.str());
     }
+
+    void summaries()
+    {
+        errout.str("");
+
+        const char * const code[] = { "void f() { }\nvoid g() { f(); }\n",
+                                      "void h() { g(); }\n"
+                                    };
+
+        std::list<CheckUnusedFunctions::Summary> summaries;
+        for (int i = 0; i < 2; ++i)
+        {
+            std::ostringstream fname;
+            fname << "test" << (i + 1) << ".cpp";
+
+            Settings settings;
+            Tokenizer tokenizer(&settings, this);
+            std::istringstream istr(code[i]);
+            tokenizer.tokenize(istr, fname.str().c_str());
+
+            summaries.push_back(CheckUnusedFunctions::Summary());
+            CheckUnusedFunctions::summarize(tokenizer, summaries.back());
+        }
+
+        std::list<CheckUnusedFunctions::Summary> deserialized;
+        ASSERT_EQUALS(true, CheckUnusedFunctions::deserialize(CheckUnusedFunctions::serialize(summaries), deserialized));
+        ASSERT_EQUALS(2U, deserialized.size());
+
+        CheckUnusedFunctions c;
+        for (std::list<CheckUnusedFunctions::Summary>::const_iterator it = deserialized.begin(); it != deserialized.end(); ++it)
+            c.merge(*it);
+        c.check(this);
+
+        ASSERT_EQUALS("[test2.cpp:1]: (style) The function 'h' is never used\n", errout.str());
+    }
 };
 
 REGISTER_TEST(TestUnusedFunctions)